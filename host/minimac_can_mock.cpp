@@ -0,0 +1,439 @@
+/**
+ * @file minimac_can_mock.cpp
+ * @brief 호스트용 MCP2515 모델 구현
+ */
+
+#include "minimac_can_mock.h"
+
+#include <string.h>
+
+/// 레지스터 주소와 비트 (MCP2515 데이터시트)
+static const uint8_t REG_CANSTAT = 0x0E;
+static const uint8_t REG_CANCTRL = 0x0F;
+static const uint8_t REG_CANINTE = 0x2B;
+static const uint8_t REG_CANINTF = 0x2C;
+static const uint8_t REG_EFLG = 0x2D;
+static const uint8_t REG_TXB0CTRL = 0x30; ///< TXBn은 0x10 간격
+static const uint8_t REG_RXB0CTRL = 0x60; ///< RXBn은 0x10 간격
+static const uint8_t TXREQ = 0x08;
+static const uint8_t ABTF = 0x40;
+static const uint8_t ABAT = 0x10;
+static const uint8_t SIDL_IDE = 0x08;
+static const uint8_t SIDL_SRR = 0x10;
+static const uint8_t MODE_NORMAL = 0x00;
+static const uint8_t MODE_LOOPBACK = 0x40;
+static const uint8_t MODE_LISTEN = 0x60;
+static const uint8_t MODE_CONFIG = 0x80;
+
+/// 한 CS 구간 안의 명령 해석 단계
+enum MockState {
+  ST_IDLE,   ///< 명령 끝 (나머지 바이트 무시)
+  ST_CMD,    ///< 명령 바이트 대기
+  ST_ADDR,   ///< READ/WRITE/BIT MODIFY 주소 대기
+  ST_READ,   ///< 레지스터 연속 읽기
+  ST_WRITE,  ///< 레지스터 연속 쓰기
+  ST_MASK,   ///< BIT MODIFY 마스크 대기
+  ST_DATA,   ///< BIT MODIFY 데이터 대기
+  ST_LOAD,   ///< LOAD TX BUFFER 연속 쓰기 (TXREQ 해석 없음)
+  ST_STATUS, ///< READ STATUS 응답
+  ST_RXSTAT  ///< RX STATUS 응답
+};
+
+/// 송신 큐에 쌓인 프레임
+typedef struct {
+  uint32_t id;
+  uint8_t len;
+  uint8_t data[8];
+} MockFrame;
+
+/// 보관하는 송신 프레임 수 (넘치면 가장 오래된 것부터 버림)
+static const uint16_t SENT_MAX = 256;
+
+static uint8_t reg[128];             ///< 레지스터 파일
+static MockState st;                 ///< 현재 명령 단계
+static uint8_t ins;                  ///< 현재 명령 바이트
+static uint8_t addr;                 ///< 현재 레지스터 주소
+static uint8_t mod_mask;             ///< BIT MODIFY 마스크
+static int8_t rx_read;               ///< READ RX BUFFER 중인 버퍼 (-1 없음)
+static MockFrame sent[SENT_MAX];     ///< 송신 프레임 링
+static uint16_t sent_head, sent_cnt; ///< 송신 링 시작, 개수
+static bool stall;                   ///< 버스 응답 없음 흉내
+static uint32_t spi_bytes, spi_cmds; ///< SPI 계수기
+static uint32_t overruns;            ///< 수신 오버런 횟수
+static uint32_t now_us;              ///< 모델 시각(µs)
+
+/**
+ * @brief 레지스터 초기값 (RESET 명령, 전원 투입)
+ */
+static void regs_reset(void) {
+  memset(reg, 0, sizeof(reg));
+  reg[REG_CANSTAT] = MODE_CONFIG;
+  reg[REG_CANCTRL] = MODE_CONFIG | 0x07;
+}
+
+static uint8_t mode(void) { return reg[REG_CANSTAT] & 0xE0; }
+
+/**
+ * @brief 프레임을 레지스터 형식(SIDH, SIDL, EID8, EID0, DLC, 데이터)으로
+ */
+static void frame_store(uint8_t *r, uint32_t id, uint8_t len,
+                        const uint8_t *data) {
+  if (id & 0x80000000UL) {
+    uint32_t x = id & 0x1FFFFFFFUL;
+    r[0] = (uint8_t)(x >> 21);
+    r[1] = (uint8_t)(((x >> 18) & 7) << 5 | SIDL_IDE | ((x >> 16) & 3));
+    r[2] = (uint8_t)(x >> 8);
+    r[3] = (uint8_t)x;
+    r[4] = (uint8_t)((id & 0x40000000UL) ? 0x40 | len : len);
+  } else {
+    uint16_t s = id & 0x7FF;
+    r[0] = (uint8_t)(s >> 3);
+    r[1] = (uint8_t)(s << 5 | ((id & 0x40000000UL) ? SIDL_SRR : 0));
+    r[2] = r[3] = 0;
+    r[4] = len;
+  }
+  memcpy(r + 5, data, len);
+}
+
+/**
+ * @brief 필터 n(0..5)이 표준/확장 ID를 통과시키는지
+ */
+static bool filter_hit(uint8_t n, uint32_t id) {
+  const uint8_t *f = &reg[n < 3 ? 4 * n : 0x10 + 4 * (n - 3)];
+  const uint8_t *m = &reg[n < 2 ? 0x20 : 0x24];
+  bool ext = id & 0x80000000UL;
+  if (((f[1] & SIDL_IDE) != 0) != ext)
+    return false;
+  if (!ext) {
+    uint16_t fid = (uint16_t)(f[0] << 3 | f[1] >> 5);
+    uint16_t mid = (uint16_t)(m[0] << 3 | m[1] >> 5);
+    return ((id ^ fid) & mid) == 0;
+  }
+  uint32_t x = id & 0x1FFFFFFFUL;
+  uint32_t fid = (uint32_t)f[0] << 21 | (uint32_t)(f[1] >> 5) << 18 |
+                 (uint32_t)(f[1] & 3) << 16 | f[2] << 8 | f[3];
+  uint32_t mid = (uint32_t)m[0] << 21 | (uint32_t)(m[1] >> 5) << 18 |
+                 (uint32_t)(m[1] & 3) << 16 | m[2] << 8 | m[3];
+  return ((x ^ fid) & mid) == 0;
+}
+
+/**
+ * @brief 수신 버퍼 n(0, 1)의 필터 중 통과시키는 것 (-1 없음)
+ */
+static int8_t buffer_hit(uint8_t n, uint32_t id) {
+  uint8_t rxm = reg[REG_RXB0CTRL + 0x10 * n] & 0x60;
+  if (rxm == 0x60)
+    return n == 0 ? 0 : 2;
+  if (rxm != 0)
+    return -1;
+  for (uint8_t f = n == 0 ? 0 : 2; f < (n == 0 ? 2 : 6); f++)
+    if (filter_hit(f, id))
+      return (int8_t)f;
+  return -1;
+}
+
+/**
+ * @brief 수신 버퍼 n에 프레임 저장 후 RXnIF 설정
+ */
+static void rx_store(uint8_t n, int8_t filhit, uint32_t id, uint8_t len,
+                     const uint8_t *data) {
+  uint8_t base = REG_RXB0CTRL + 0x10 * n;
+  uint8_t fmask = n == 0 ? 0x01 : 0x07; /* RXB0CTRL.BUKT는 보존 */
+  reg[base] = (uint8_t)((reg[base] & ~fmask) | (filhit & fmask));
+  frame_store(&reg[base + 1], id, len, data);
+  reg[REG_CANINTF] |= 1 << n;
+}
+
+/**
+ * @brief 버스 프레임 수신 처리 (필터, RXB0 → RXB1 rollover, 오버런)
+ */
+static bool rx_frame(uint32_t id, uint8_t len, const uint8_t *data) {
+  int8_t f0 = buffer_hit(0, id);
+  if (f0 >= 0) {
+    if (!(reg[REG_CANINTF] & 0x01)) {
+      rx_store(0, f0, id, len, data);
+      return true;
+    }
+    if ((reg[REG_RXB0CTRL] & 0x04) && !(reg[REG_CANINTF] & 0x02)) {
+      rx_store(1, f0, id, len, data);
+      return true;
+    }
+    reg[REG_EFLG] |= 0x40;
+    overruns++;
+    return false;
+  }
+  int8_t f1 = buffer_hit(1, id);
+  if (f1 < 0)
+    return false;
+  if (reg[REG_CANINTF] & 0x02) {
+    reg[REG_EFLG] |= 0x80;
+    overruns++;
+    return false;
+  }
+  rx_store(1, f1, id, len, data);
+  return true;
+}
+
+/**
+ * @brief 다음에 버스에 나갈 송신 버퍼 (TXP가 높은 것, 같으면 번호가 큰 것)
+ * @return 버퍼 번호, 정상/루프백 모드가 아니거나 대기 중인 버퍼가 없으면 -1
+ */
+static int8_t tx_next(void) {
+  uint8_t m = mode();
+  if (m != MODE_NORMAL && m != MODE_LOOPBACK)
+    return -1;
+  int8_t best = -1;
+  for (uint8_t n = 0; n < 3; n++) {
+    uint8_t c = reg[REG_TXB0CTRL + 0x10 * n];
+    if ((c & TXREQ) &&
+        (best < 0 || (c & 3) >= (reg[REG_TXB0CTRL + 0x10 * best] & 3)))
+      best = (int8_t)n;
+  }
+  return best;
+}
+
+/**
+ * @brief 송신 버퍼 n의 프레임을 버스로 보냄 (루프백이면 수신 쪽으로)
+ */
+static void tx_send(uint8_t n) {
+  uint8_t base = REG_TXB0CTRL + 0x10 * n;
+  uint8_t m = mode();
+
+  /* 레지스터 형식에서 프레임 복원 */
+  const uint8_t *r = &reg[base + 1];
+  MockFrame fr;
+  if (r[1] & SIDL_IDE)
+    fr.id = 0x80000000UL | (uint32_t)r[0] << 21 |
+            (uint32_t)(r[1] >> 5) << 18 | (uint32_t)(r[1] & 3) << 16 |
+            r[2] << 8 | r[3];
+  else
+    fr.id = (uint32_t)(r[0] << 3 | r[1] >> 5);
+  fr.len = r[4] & 0x0F;
+  if (fr.len > 8)
+    fr.len = 8;
+  memcpy(fr.data, r + 5, fr.len);
+
+  reg[base] &= ~TXREQ;
+  reg[REG_CANINTF] |= 0x04 << n;
+  if (m == MODE_LOOPBACK) {
+    rx_frame(fr.id, fr.len, fr.data);
+    return;
+  }
+  if (sent_cnt == SENT_MAX) {
+    sent_head = (sent_head + 1) % SENT_MAX;
+    sent_cnt--;
+  }
+  sent[(sent_head + sent_cnt++) % SENT_MAX] = fr;
+}
+
+/**
+ * @brief 대기 중인 전송 요청 처리 (버스가 응답하면 칩의 전송 순서로 모두)
+ */
+static void tx_run(void) {
+  int8_t n;
+  while (!stall && (n = tx_next()) >= 0)
+    tx_send((uint8_t)n);
+}
+
+/**
+ * @brief 레지스터 쓰기 (모드 전환, TXREQ 해석 포함)
+ */
+static void reg_write(uint8_t a, uint8_t v) {
+  a &= 0x7F;
+  if ((a & 0x0F) == 0x0F) {
+    /* CANCTRL: 요청한 모드로 바로 전환 (모든 xFh 주소에 보임),
+     * ABAT면 대기 중인 전송 요청을 모두 취소 */
+    reg[REG_CANCTRL] = v;
+    reg[REG_CANSTAT] = (uint8_t)((reg[REG_CANSTAT] & 0x1F) | (v & 0xE0));
+    for (uint8_t n = 0; v & ABAT && n < 3; n++) {
+      uint8_t *c = &reg[REG_TXB0CTRL + 0x10 * n];
+      if (*c & TXREQ)
+        *c = (uint8_t)((*c & ~TXREQ) | ABTF);
+    }
+    tx_run();
+    return;
+  }
+  reg[a] = v;
+  if (a == REG_TXB0CTRL || a == REG_TXB0CTRL + 0x10 ||
+      a == REG_TXB0CTRL + 0x20) {
+    if (v & TXREQ)
+      reg[a] &= ~ABTF;
+    tx_run();
+  }
+}
+
+/**
+ * @brief 레지스터 읽기 (CANSTAT/CANCTRL은 모든 xEh/xFh 주소에 보임)
+ */
+static uint8_t reg_read(uint8_t a) {
+  a &= 0x7F;
+  if ((a & 0x0F) == 0x0E)
+    return reg[REG_CANSTAT];
+  if ((a & 0x0F) == 0x0F)
+    return reg[REG_CANCTRL];
+  return reg[a];
+}
+
+/**
+ * @brief READ STATUS 응답 바이트
+ */
+static uint8_t status_byte(void) {
+  uint8_t f = reg[REG_CANINTF], s = f & 0x03;
+  for (uint8_t n = 0; n < 3; n++) {
+    if (reg[REG_TXB0CTRL + 0x10 * n] & TXREQ)
+      s |= 0x04 << (2 * n);
+    if (f & (0x04 << n))
+      s |= 0x08 << (2 * n);
+  }
+  return s;
+}
+
+/**
+ * @brief RX STATUS 응답 바이트 (수신 버퍼, 프레임 종류, 필터 번호)
+ */
+static uint8_t rx_status_byte(void) {
+  uint8_t f = reg[REG_CANINTF] & 0x03;
+  if (!f)
+    return 0;
+  uint8_t n = (f & 0x01) ? 0 : 1;
+  const uint8_t *r = &reg[REG_RXB0CTRL + 0x10 * n];
+  uint8_t type = (r[2] & SIDL_IDE) ? 0x10 : 0;
+  if ((r[2] & SIDL_IDE) ? (r[5] & 0x40) : (r[2] & SIDL_SRR))
+    type |= 0x08;
+  return (uint8_t)(f << 6 | type | (r[0] & (n == 0 ? 0x01 : 0x07)));
+}
+
+void minimac_can_mock_select(void) {
+  st = ST_CMD;
+  rx_read = -1;
+}
+
+void minimac_can_mock_deselect(void) {
+  /* READ RX BUFFER는 CS 해제 때 해당 RXnIF를 지움 */
+  if (rx_read >= 0)
+    reg[REG_CANINTF] &= ~(1 << rx_read);
+  st = ST_IDLE;
+  rx_read = -1;
+  spi_cmds++;
+}
+
+uint8_t minimac_can_mock_transfer(uint8_t b) {
+  static const uint8_t rx_addr[4] = {0x61, 0x66, 0x71, 0x76};
+  static const uint8_t tx_addr[6] = {0x31, 0x36, 0x41, 0x46, 0x51, 0x56};
+  spi_bytes++;
+  now_us++;
+
+  switch (st) {
+  case ST_CMD:
+    ins = b;
+    if (b == 0xC0) {
+      regs_reset();
+      st = ST_IDLE;
+    } else if (b == 0x03 || b == 0x02 || b == 0x05) {
+      st = ST_ADDR;
+    } else if (b == 0xA0) {
+      st = ST_STATUS;
+    } else if (b == 0xB0) {
+      st = ST_RXSTAT;
+    } else if ((b & 0xF9) == 0x90) {
+      addr = rx_addr[(b >> 1) & 3];
+      rx_read = (b >> 2) & 1;
+      st = ST_READ;
+    } else if ((b & 0xF8) == 0x40 && (b & 7) < 6) {
+      addr = tx_addr[b & 7];
+      st = ST_LOAD;
+    } else if ((b & 0xF8) == 0x80) {
+      for (uint8_t n = 0; n < 3; n++) {
+        if (b & (1 << n)) {
+          reg[REG_TXB0CTRL + 0x10 * n] |= TXREQ;
+          reg[REG_TXB0CTRL + 0x10 * n] &= ~ABTF;
+        }
+      }
+      tx_run();
+      st = ST_IDLE;
+    } else {
+      st = ST_IDLE;
+    }
+    return 0;
+  case ST_ADDR:
+    addr = b;
+    st = ins == 0x03 ? ST_READ : ins == 0x02 ? ST_WRITE : ST_MASK;
+    return 0;
+  case ST_READ:
+    return reg_read(addr++);
+  case ST_WRITE:
+    reg_write(addr++, b);
+    return 0;
+  case ST_LOAD:
+    reg[addr++ & 0x7F] = b;
+    return 0;
+  case ST_MASK:
+    mod_mask = b;
+    st = ST_DATA;
+    return 0;
+  case ST_DATA:
+    reg_write(addr, (uint8_t)((reg_read(addr) & ~mod_mask) | (b & mod_mask)));
+    st = ST_IDLE;
+    return 0;
+  case ST_STATUS:
+    return status_byte();
+  case ST_RXSTAT:
+    return rx_status_byte();
+  default:
+    return 0xFF;
+  }
+}
+
+uint32_t minimac_can_mock_micros(void) { return now_us += 10; }
+
+void minimac_can_mock_reset(void) {
+  regs_reset();
+  st = ST_IDLE;
+  rx_read = -1;
+  sent_head = sent_cnt = 0;
+  stall = false;
+  spi_bytes = spi_cmds = overruns = 0;
+  now_us = 0;
+}
+
+bool minimac_can_mock_inject(uint32_t id, uint8_t len, const uint8_t *data) {
+  uint8_t m = mode();
+  if (m != MODE_NORMAL && m != MODE_LISTEN)
+    return false;
+  return rx_frame(id, len > 8 ? 8 : len, data);
+}
+
+bool minimac_can_mock_sent(uint32_t *id, uint8_t *len, uint8_t *data) {
+  if (!sent_cnt)
+    return false;
+  const MockFrame *f = &sent[sent_head];
+  *id = f->id;
+  *len = f->len;
+  memcpy(data, f->data, f->len);
+  sent_head = (sent_head + 1) % SENT_MAX;
+  sent_cnt--;
+  return true;
+}
+
+void minimac_can_mock_tx_stall(bool s) {
+  stall = s;
+  tx_run();
+}
+
+bool minimac_can_mock_tx_one(void) {
+  int8_t n = tx_next();
+  if (n < 0)
+    return false;
+  tx_send((uint8_t)n);
+  return true;
+}
+
+bool minimac_can_mock_int(void) {
+  return (reg[REG_CANINTF] & reg[REG_CANINTE]) != 0;
+}
+
+uint32_t minimac_can_mock_spi_bytes(void) { return spi_bytes; }
+
+uint32_t minimac_can_mock_spi_cmds(void) { return spi_cmds; }
+
+uint32_t minimac_can_mock_overruns(void) { return overruns; }
@@ -0,0 +1,93 @@
+/**
+ * @file minimac_can_mock.h
+ * @brief 호스트용 MCP2515 모델 (minimac_can 드라이버 시험)
+ *
+ * 장치 쪽 MCP2515 드라이버(minimac_can.cpp)를 MINIMAC_CAN_MOCK으로 컴파일하면
+ * SPI 대신 이 모델에 연결됩니다. 모델은 드라이버가 쓰는 SPI 명령(RESET,
+ * READ, WRITE, BIT MODIFY, READ STATUS, RX STATUS, READ RX BUFFER, LOAD TX
+ * BUFFER, RTS)을 레지스터 수준에서 해석하고, 버스 쪽은 시험 코드가
+ * minimac_can_mock_inject()로 프레임을 넣고 minimac_can_mock_sent()로 송신
+ * 프레임을 꺼냅니다. 수신 필터는 표준 ID 기준으로 마스크/필터, RXM,
+ * rollover를 칩과 같게 적용하고, 송신은 TX 버퍼 우선순위(TXP, 버퍼 번호)
+ * 순서와 ABAT 취소를 칩과 같게 따릅니다. SPI 바이트 수를 세어 프레임당 SPI
+ * 비용을 잽니다. 드라이버 시험 프로그램은 minimac_can_test.cpp입니다.
+ *
+ * @code
+ * g++ -O2 -std=gnu++11 -DMINIMAC_CAN_MOCK -I host -c \
+ *     receive_check/minimac_can.cpp host/minimac_can_mock.cpp
+ * @endcode
+ */
+#ifndef MINIMAC_CAN_MOCK_H
+#define MINIMAC_CAN_MOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @name 드라이버 쪽 SPI 연결 (minimac_can.cpp 전용)
+/// @{
+void minimac_can_mock_select(void);
+void minimac_can_mock_deselect(void);
+uint8_t minimac_can_mock_transfer(uint8_t b);
+uint32_t minimac_can_mock_micros(void);
+/// @}
+
+/**
+ * @brief 모델을 전원 투입 상태로 (레지스터, 송신 큐, 계수기 초기화)
+ */
+void minimac_can_mock_reset(void);
+
+/**
+ * @brief 버스에서 프레임 하나 도착 (칩의 수신 필터 적용)
+ * @param id   CAN ID (bit 31이 켜져 있으면 확장 ID)
+ * @param len  데이터 길이 (0..8)
+ * @param data 데이터
+ * @return true  수신 버퍼에 저장됨
+ * @return false 필터에 걸리지 않음, 정상/수신 전용 모드가 아님, 또는 버퍼가
+ *               차서 오버런
+ */
+bool minimac_can_mock_inject(uint32_t id, uint8_t len, const uint8_t *data);
+
+/**
+ * @brief 칩이 버스로 보낸 프레임 하나 꺼내기 (보낸 순서)
+ * @param id   CAN ID
+ * @param len  데이터 길이
+ * @param data 데이터 (8바이트 이상)
+ * @return true 꺼냄, false 보낸 프레임 없음
+ */
+bool minimac_can_mock_sent(uint32_t *id, uint8_t *len, uint8_t *data);
+
+/**
+ * @brief 버스 응답 없음 흉내 (true면 전송 요청이 TXREQ에 머묾)
+ */
+void minimac_can_mock_tx_stall(bool stall);
+
+/**
+ * @brief 버스 응답 없음 상태에서 대기 중인 프레임 하나만 전송
+ * @return true 전송함, false 대기 중인 전송 요청 없음
+ *
+ * 칩과 같이 TXP가 가장 높은 버퍼, 같으면 번호가 가장 큰 버퍼를 고릅니다.
+ */
+bool minimac_can_mock_tx_one(void);
+
+/**
+ * @brief INT 핀 상태
+ * @return true LOW (CANINTF & CANINTE != 0)
+ */
+bool minimac_can_mock_int(void);
+
+/**
+ * @brief 지금까지 오간 SPI 바이트 수 (명령 바이트 포함)
+ */
+uint32_t minimac_can_mock_spi_bytes(void);
+
+/**
+ * @brief 지금까지의 CS 구간(SPI 명령) 수
+ */
+uint32_t minimac_can_mock_spi_cmds(void);
+
+/**
+ * @brief 수신 오버런 횟수 (EFLG.RX0OVR/RX1OVR가 켜진 횟수)
+ */
+uint32_t minimac_can_mock_overruns(void);
+
+#endif // MINIMAC_CAN_MOCK_H
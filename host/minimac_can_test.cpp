@@ -0,0 +1,279 @@
+/**
+ * @file minimac_can_test.cpp
+ * @brief MCP2515 드라이버(minimac_can) 호스트 시험 (MCP2515 모델 사용)
+ *
+ * 장치 쪽 드라이버를 MINIMAC_CAN_MOCK으로 컴파일해 host/의 MCP2515 모델에
+ * 연결하고, 수신 rollover 순서, 마스크/필터, 수신 오버런, MiniMacCanTx의
+ * 전송 순서와 취소, 프레임별 전송 결과 알림 순서를 확인합니다. 실패한 항목을 출력하고 하나라도 실패하면
+ * 1을 반환합니다.
+ *
+ * @code
+ * g++ -O2 -std=gnu++11 -Wall -Wextra -DMINIMAC_CAN_MOCK -I host \
+ *     -I receive_check host/minimac_can_test.cpp host/minimac_can_mock.cpp \
+ *     receive_check/minimac_can.cpp -o minimac_can_test && ./minimac_can_test
+ * @endcode
+ */
+
+#include "minimac_can.h"
+#include "minimac_can_mock.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static unsigned fails; ///< 실패한 검사 수
+
+/**
+ * @brief 검사 하나 (실패하면 이름을 출력하고 계수)
+ */
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    fails++;
+  }
+}
+
+/**
+ * @brief 모델을 초기화하고 드라이버를 정상 모드로 (필터는 모두 통과)
+ */
+static void setup(MiniMacCan &can) {
+  minimac_can_mock_reset();
+  check(can.begin(500, 16), "begin");
+  check(can.set_mode(MiniMacCan::MODE_NORMAL), "set_mode");
+}
+
+/**
+ * @brief 데이터 첫 바이트에 순번을 담은 프레임 하나 주입
+ */
+static bool inject(uint32_t id, uint8_t seq) {
+  uint8_t d[8] = {seq};
+  return minimac_can_mock_inject(id, 8, d);
+}
+
+/**
+ * @brief 프레임 하나를 읽어 순번 반환 (-1 비어 있음)
+ */
+static int read_seq(MiniMacCan &can, uint32_t *id = NULL) {
+  uint32_t i;
+  uint8_t len, d[8];
+  if (!can.read(&i, &len, d))
+    return -1;
+  if (id)
+    *id = i;
+  return d[0];
+}
+
+/**
+ * @brief RXB0 → RXB1 rollover에서 도착 순서 유지
+ */
+static void test_rx_order(void) {
+  MiniMacCan can(10);
+  setup(can);
+
+  /* (1) 1, 2 도착(2는 RXB1로), 1을 읽은 뒤 3이 RXB0에 도착 → 2, 3 순서 */
+  inject(0x100, 1);
+  inject(0x100, 2);
+  check(read_seq(can) == 1, "rollover: first frame");
+  inject(0x100, 3);
+  check(read_seq(can) == 2, "rollover: RXB1 before refilled RXB0");
+  check(read_seq(can) == 3, "rollover: refilled RXB0 last");
+  check(read_seq(can) == -1, "rollover: empty");
+
+  /* (2) 도착 1..2회, 읽기 1회를 섞어도 순번이 이어짐 */
+  uint8_t next = 0, expect = 0;
+  for (unsigned i = 0; i < 2000; i++) {
+    unsigned burst = 1 + (i * 7 / 3) % 2;
+    for (unsigned k = 0; k < burst; k++)
+      if (inject(0x100, next))
+        next++;
+    int s = read_seq(can);
+    if (s >= 0) {
+      check(s == expect, "rollover: sequence");
+      expect = (uint8_t)(s + 1);
+    }
+  }
+  for (int s; (s = read_seq(can)) >= 0; expect++)
+    check(s == expect, "rollover: drain");
+  check(expect == next, "rollover: all frames read");
+}
+
+/**
+ * @brief 마스크/필터: 등록한 표준 ID만 통과, 확장 ID는 거름
+ */
+static void test_filter(void) {
+  MiniMacCan can(10);
+  minimac_can_mock_reset();
+  check(can.begin(500, 16), "begin");
+  const uint16_t mask[2] = {0x7FF, 0x7F0};
+  const uint16_t filt[6] = {0x100, 0x101, 0x200, 0x200, 0x200, 0x200};
+  can.set_filter(mask, filt);
+  check(can.set_mode(MiniMacCan::MODE_NORMAL), "set_mode");
+
+  uint32_t id;
+  check(inject(0x101, 1) && read_seq(can, &id) == 1 && id == 0x101,
+        "filter: RXF1 hit");
+  check(inject(0x20A, 2) && read_seq(can, &id) == 2 && id == 0x20A,
+        "filter: RXM1 don't-care bits");
+  check(!inject(0x102, 3), "filter: unregistered ID rejected");
+  check(!inject(0x210, 4), "filter: RXM1 compared bits");
+  check(!inject(0x80000100UL, 5), "filter: extended ID rejected");
+  check(read_seq(can) == -1, "filter: nothing stored");
+}
+
+/**
+ * @brief 두 수신 버퍼가 차면 오버런 (먼저 온 두 프레임은 보존)
+ */
+static void test_overrun(void) {
+  MiniMacCan can(10);
+  setup(can);
+
+  check(inject(0x100, 1) && inject(0x100, 2), "overrun: two buffers");
+  check(!inject(0x100, 3), "overrun: third frame dropped");
+  check(minimac_can_mock_overruns() == 1, "overrun: counted");
+  check(read_seq(can) == 1 && read_seq(can) == 2 && read_seq(can) == -1,
+        "overrun: kept frames in order");
+}
+
+/**
+ * @brief 전송 완료 인터럽트 흉내 (INT 핀이 LOW면 ISR 호출)
+ */
+static void irq(MiniMacCanTx &txq) {
+  if (minimac_can_mock_int())
+    txq.service();
+}
+
+/**
+ * @brief 버스로 나간 프레임의 순번이 기대값부터 이어지는지 확인
+ */
+static void drain_sent(uint8_t *expect) {
+  uint32_t id;
+  uint8_t len, d[8];
+  while (minimac_can_mock_sent(&id, &len, d)) {
+    check(d[0] == *expect && id == 0x123, "tx: send order");
+    (*expect)++;
+  }
+}
+
+/**
+ * @brief MiniMacCanTx: TX 버퍼 3개에 걸쳐 넣은 순서대로 전송, 취소
+ */
+static void test_tx_queue(void) {
+  MiniMacCan can(10);
+  MiniMacCanTx txq(can);
+  setup(can);
+  txq.begin();
+
+  /* (1) 버스가 멈춘 동안 큐 + TX 버퍼 3개를 채운 뒤 한 프레임씩 전송 */
+  minimac_can_mock_tx_stall(true);
+  uint8_t d[8] = {0}, expect = 0;
+  unsigned n = 0;
+  while (txq.push(0x123, 8, d))
+    d[0] = (uint8_t)++n;
+  check(n == MINIMAC_CAN_TXQ_LEN + 3, "tx: queue + 3 buffers");
+  check(!txq.room() && txq.pending() == n, "tx: full");
+  while (minimac_can_mock_tx_one()) {
+    irq(txq);
+    drain_sent(&expect);
+  }
+  check(expect == n && txq.pending() == 0, "tx: all sent");
+  check(!minimac_can_mock_int(), "tx: INT released");
+
+  /* (2) 넣기, 한 프레임 전송, 인터럽트를 섞어도 순서 유지 */
+  for (unsigned i = 0; i < 3000; i++) {
+    unsigned r = (i * 13 + i / 7) % 4;
+    if (r < 2 && txq.push(0x123, 8, d))
+      d[0]++;
+    else if (r == 2)
+      minimac_can_mock_tx_one();
+    irq(txq);
+    drain_sent(&expect);
+  }
+  while (minimac_can_mock_tx_one()) {
+    irq(txq);
+    drain_sent(&expect);
+  }
+  check(expect == d[0], "tx: interleaved all sent");
+
+  /* (3) 취소: 한 프레임만 나간 뒤 나머지를 버림 */
+  for (unsigned i = 0; i < 5; i++) {
+    txq.push(0x123, 8, d);
+    d[0]++;
+  }
+  minimac_can_mock_tx_one();
+  irq(txq);
+  drain_sent(&expect);
+  check(txq.abort() == 4 && txq.pending() == 0, "tx: abort count");
+  minimac_can_mock_tx_stall(false);
+  check(!minimac_can_mock_tx_one(), "tx: nothing left after abort");
+
+  /* (4) 취소 뒤에도 다시 전송 */
+  expect = d[0];
+  check(txq.push(0x123, 8, d), "tx: push after abort");
+  irq(txq);
+  drain_sent(&expect);
+  check(expect == (uint8_t)(d[0] + 1), "tx: sent after abort");
+}
+
+/// 전송 결과 알림 기록: 태그 번호 + 1, 실패면 음수 (push() 순서여야 함)
+static int done_log[16];
+static uint8_t done_cnt;
+
+/**
+ * @brief 전송 결과 알림 함수 (태그는 번호를 담은 int)
+ */
+static void on_done(void *tag, bool sent) {
+  int k = *(const int *)tag + 1;
+  if (done_cnt < sizeof(done_log) / sizeof(done_log[0]))
+    done_log[done_cnt++] = sent ? k : -k;
+}
+
+/**
+ * @brief MiniMacCanTx: 완료는 service()에서, 취소는 abort()에서 넣은 순서로
+ *        알림 (태그가 NULL인 프레임은 알리지 않음)
+ */
+static void test_tx_done(void) {
+  static int tags[6] = {0, 1, 2, 3, 4, 5};
+  MiniMacCan can(10);
+  MiniMacCanTx txq(can, on_done);
+  setup(can);
+  txq.begin();
+  done_cnt = 0;
+
+  /* (1) 버스가 멈춘 동안 6프레임 (TX 버퍼 3개 + 큐 3개), 1번은 태그 없음 */
+  minimac_can_mock_tx_stall(true);
+  uint8_t d[8] = {0};
+  for (uint8_t i = 0; i < 6; i++) {
+    d[0] = i;
+    txq.push(0x123, 8, d, i == 1 ? NULL : &tags[i]);
+  }
+  check(done_cnt == 0, "done: nothing before send");
+
+  /* (2) 두 프레임 전송 + 인터럽트: 0번만 완료로 알림 */
+  for (uint8_t i = 0; i < 2; i++) {
+    minimac_can_mock_tx_one();
+    irq(txq);
+  }
+  check(done_cnt == 1 && done_log[0] == 1, "done: service reports sent");
+
+  /* (3) 인터럽트 처리 전에 2번이 나가고 취소: 2번 완료, 3..5번 실패 순 */
+  minimac_can_mock_tx_one();
+  check(txq.abort() == 3, "done: abort count");
+  static const int expect[5] = {1, 3, -4, -5, -6};
+  check(done_cnt == 5 && memcmp(done_log, expect, sizeof(expect)) == 0,
+        "done: abort reports sent then lost in queue order");
+  minimac_can_mock_tx_stall(false);
+
+  /* (4) 취소 뒤 새 프레임도 한 번만 알림 */
+  txq.push(0x123, 8, d, &tags[0]);
+  irq(txq);
+  check(done_cnt == 6 && done_log[5] == 1, "done: report after abort");
+}
+
+int main(void) {
+  test_rx_order();
+  test_filter();
+  test_overrun();
+  test_tx_queue();
+  test_tx_done();
+  printf("%s\n", fails ? "FAILED" : "OK");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file minimac_host.cpp
+ * @brief 호스트용 Mini-MAC 일괄 검증 구현
+ */
+
+#include "minimac_host.h"
+
+#include <string.h>
+
+/// 재동기화 프레임 카운터 하위 비트 수 (장치의 RESYNC_CTR_BITS)
+static const uint8_t HOST_RESYNC_CTR_BITS = 21;
+static const uint32_t HOST_RESYNC_CTR_MASK = (1UL << HOST_RESYNC_CTR_BITS) - 1;
+
+/// 재동기화 태그용 ID 도메인 비트 (장치의 RESYNC_DOMAIN)
+static const uint16_t HOST_RESYNC_DOMAIN = 0x8000;
+
+/**
+ * @brief 가장 오래된 히스토리 항목 삭제
+ */
+static void host_hist_drop(MiniMacHostCtx *ctx) {
+  uint8_t len = ctx->hist_len[0];
+  ctx->hist_used -= 1 + len;
+  ctx->hist_data -= len;
+  ctx->hist_cnt--;
+  memmove(ctx->hist, ctx->hist + len, ctx->hist_data);
+  memmove(ctx->hist_len, ctx->hist_len + 1, ctx->hist_cnt);
+}
+
+/**
+ * @brief 히스토리에 페이로드 추가 (장치의 MiniMac::hist_push()와 같은 삭제 규칙)
+ */
+static void host_hist_push(MiniMacHostCtx *ctx, const uint8_t *data,
+                           uint8_t len) {
+  if (ctx->hist_cnt == ctx->lambda)
+    host_hist_drop(ctx);
+  while (ctx->hist_used + 1 + len > ctx->hist_bytes)
+    host_hist_drop(ctx);
+
+  memcpy(ctx->hist + ctx->hist_data, data, len);
+  ctx->hist_len[ctx->hist_cnt++] = len;
+  ctx->hist_data += len;
+  ctx->hist_used += 1 + len;
+}
+
+/**
+ * @brief 히스토리 비우기 (재동기화)
+ */
+static void host_hist_clear(MiniMacHostCtx *ctx) {
+  ctx->hist_cnt = 0;
+  ctx->hist_used = 0;
+  ctx->hist_data = 0;
+}
+
+/**
+ * @brief 다이제스트 입력 머리: 카운터(BE 8) ‖ ID(BE 2)
+ */
+static void host_header(uint64_t ctr, uint16_t id, uint8_t *out) {
+  for (int i = 7; i >= 0; i--) {
+    out[i] = (uint8_t)ctr;
+    ctr >>= 8;
+  }
+  out[8] = (uint8_t)(id >> 8);
+  out[9] = (uint8_t)id;
+}
+
+/**
+ * @brief 다이제스트 입력 구성: 카운터(BE 8) ‖ ID(BE 2) ‖ 히스토리 ‖ 페이로드
+ * @return 입력 길이(Byte)
+ */
+static uint8_t host_input(const MiniMacHostCtx *ctx, const uint8_t *data,
+                          uint8_t len, uint8_t *out) {
+  host_header(ctx->counter, ctx->id, out);
+  memcpy(out + 10, ctx->hist, ctx->hist_data);
+  memcpy(out + 10 + ctx->hist_data, data, len);
+  return (uint8_t)(10 + ctx->hist_data + len);
+}
+
+/**
+ * @brief 재동기화 프레임의 길이와 대상 ID 확인
+ */
+static bool host_resync_ok(const MiniMacHostCtx *ctx, const uint8_t *data,
+                           uint8_t len) {
+  return len == MINIMAC_HOST_RESYNC_LEN + ctx->tag_len &&
+         minimac_host_resync_id(data, len) == (ctx->id & 0x7FF);
+}
+
+/**
+ * @brief 재동기화 프레임의 송신 측 카운터 복원
+ *
+ * 현재 카운터 이상이면서 하위 21비트가 페이로드와 같은 가장 작은 값
+ * (장치의 MiniMac::resync()와 같음).
+ */
+static uint64_t host_resync_ctr(const MiniMacHostCtx *ctx,
+                                const uint8_t *data) {
+  uint32_t w = 0;
+  for (uint8_t i = 0; i < MINIMAC_HOST_RESYNC_LEN; i++)
+    w = w << 8 | data[i];
+  return ctx->counter + ((w - (uint32_t)ctx->counter) & HOST_RESYNC_CTR_MASK);
+}
+
+/**
+ * @brief 재동기화 다이제스트 입력: 카운터 ‖ (ID | 0x8000) ‖ 페이로드
+ * @return 입력 길이(Byte)
+ */
+static uint8_t host_resync_input(const MiniMacHostCtx *ctx, uint64_t ctr,
+                                 const uint8_t *data, uint8_t *out) {
+  host_header(ctr, ctx->id | HOST_RESYNC_DOMAIN, out);
+  memcpy(out + 10, data, MINIMAC_HOST_RESYNC_LEN);
+  return 10 + MINIMAC_HOST_RESYNC_LEN;
+}
+
+uint16_t minimac_host_resync_id(const uint8_t *data, uint8_t len) {
+  if (len < MINIMAC_HOST_RESYNC_LEN)
+    return 0xFFFF;
+  return (uint16_t)(data[0] << 3 | data[1] >> 5);
+}
+
+bool minimac_host_init(MiniMacHostCtx *ctx, uint16_t can_id,
+                       const uint8_t *key, uint8_t key_len, uint8_t tag_len,
+                       uint8_t lambda, uint16_t hist_bytes) {
+  if (hist_bytes == 0)
+    hist_bytes = (uint16_t)(lambda * (1 + MINIMAC_HOST_MAX_DATA));
+  if (key_len < 1 || key_len > 64 || tag_len < 1 || tag_len > 16 ||
+      lambda < 1 || lambda == 255 || hist_bytes > MINIMAC_HOST_HIST_MAX ||
+      hist_bytes < 1 + MINIMAC_HOST_MAX_DATA)
+    return false;
+
+  memset(ctx, 0, sizeof(*ctx));
+  minimac_mb_key(&ctx->key, key, key_len);
+  ctx->id = can_id;
+  ctx->tag_len = tag_len;
+  ctx->lambda = lambda;
+  ctx->hist_bytes = (uint8_t)hist_bytes;
+  return true;
+}
+
+void minimac_host_verify_batch(const MiniMacHostFrame *frames, size_t n,
+                               bool *results) {
+  uint8_t msg[MINIMAC_HOST_WINDOW][255];
+  MiniMacMbJob jobs[MINIMAC_HOST_WINDOW];
+  uint8_t pending[MINIMAC_HOST_WINDOW], wave[MINIMAC_HOST_WINDOW];
+  uint64_t resync_ctr[MINIMAC_HOST_WINDOW];
+
+  for (size_t base = 0; base < n; base += MINIMAC_HOST_WINDOW) {
+    const MiniMacHostFrame *f = frames + base;
+    bool *res = results + base;
+    uint8_t cnt = n - base < MINIMAC_HOST_WINDOW ? (uint8_t)(n - base)
+                                                 : MINIMAC_HOST_WINDOW;
+
+    /* (1) 길이(재동기화는 대상 ID도)가 맞지 않는 프레임은 바로 실패,
+     *     나머지는 대기 목록에 */
+    uint8_t npend = 0;
+    for (uint8_t i = 0; i < cnt; i++) {
+      res[i] = false;
+      bool ok = f[i].resync
+                    ? host_resync_ok(f[i].ctx, f[i].data, f[i].len)
+                    : f[i].len >= f[i].ctx->tag_len &&
+                          f[i].len - f[i].ctx->tag_len <= MINIMAC_HOST_MAX_DATA;
+      if (ok)
+        pending[npend++] = i;
+    }
+
+    while (npend > 0) {
+      /* (2) 웨이브 구성: CAN ID마다 대기 중인 가장 앞선 프레임 하나 */
+      uint8_t nwave = 0, nleft = 0;
+      for (uint8_t p = 0; p < npend; p++) {
+        uint8_t i = pending[p];
+        bool busy = false;
+        for (uint8_t w = 0; w < nwave && !busy; w++)
+          busy = f[wave[w]].ctx == f[i].ctx;
+        if (busy) {
+          pending[nleft++] = i;
+          continue;
+        }
+        MiniMacHostCtx *ctx = f[i].ctx;
+        jobs[nwave].key = &ctx->key;
+        jobs[nwave].msg = msg[nwave];
+        if (f[i].resync) {
+          resync_ctr[nwave] = host_resync_ctr(ctx, f[i].data);
+          jobs[nwave].len = host_resync_input(ctx, resync_ctr[nwave],
+                                              f[i].data, msg[nwave]);
+        } else {
+          jobs[nwave].len = host_input(ctx, f[i].data,
+                                       f[i].len - ctx->tag_len, msg[nwave]);
+        }
+        wave[nwave++] = i;
+      }
+      npend = nleft;
+
+      /* (3) 웨이브 전체를 SIMD 레인에 나눠 계산 */
+      minimac_mb_hmac_md5(jobs, nwave);
+
+      /* (4) 태그 비교, 성공 시 히스토리·카운터 갱신 (다음 웨이브에 반영).
+       *     재동기화는 카운터를 복원한 값 + 1로 옮기고 히스토리를 비움 */
+      for (uint8_t w = 0; w < nwave; w++) {
+        const MiniMacHostFrame *fr = &f[wave[w]];
+        MiniMacHostCtx *ctx = fr->ctx;
+        uint8_t payload_len = fr->len - ctx->tag_len;
+        if (memcmp(jobs[w].digest, fr->data + payload_len, ctx->tag_len) != 0)
+          continue;
+        if (fr->resync) {
+          ctx->counter = resync_ctr[w] + 1;
+          host_hist_clear(ctx);
+        } else {
+          host_hist_push(ctx, fr->data, payload_len);
+          ctx->counter++;
+        }
+        res[wave[w]] = true;
+      }
+    }
+  }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file minimac_host.h
+ * @brief 호스트(리눅스 게이트웨이)용 Mini-MAC 일괄 검증
+ *
+ * 여러 CAN 버스에서 모은 프레임을 한 번에 넘기면, 서로 다른 CAN ID의
+ * 프레임끼리 묶어(웨이브) minimac_mb_hmac_md5()의 SIMD 레인에 나눠 다이제스트를
+ * 계산합니다. 같은 ID의 프레임은 앞 프레임의 검증 결과(카운터, 히스토리)에
+ * 의존하므로 도착 순서대로 서로 다른 웨이브에 들어갑니다. 결과와 상태
+ * 변화는 프레임을 하나씩 MiniMac::verify()에 넣은 것과 같습니다.
+ *
+ * 다이제스트 입력과 히스토리 관리(λ개 또는 링 버퍼 크기 초과 시 오래된
+ * 항목 삭제)는 장치 쪽 엔진(minimac_engine.h)과 같고, MAC은 기본 백엔드인
+ * HMAC-MD5만 지원합니다. 카운터는 0에서 시작하며 EEPROM 저널은 없습니다.
+ *
+ * 재동기화 프레임(MINIMAC_HOST_RESYNC_ID)도 같은 배열에 넣을 수 있습니다.
+ * 호출자는 minimac_host_resync_id()로 페이로드가 가리키는 ID의 상태를 골라
+ * resync를 켜고 넘기며, 결과와 상태 변화는 장치의 MiniMac::resync()와
+ * 같습니다.
+ */
+#ifndef MINIMAC_HOST_H
+#define MINIMAC_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minimac_mb.h"
+
+/// 페이로드 최대 길이(Byte, 클래식 CAN)
+static const uint8_t MINIMAC_HOST_MAX_DATA = 8;
+
+/// 히스토리 링 버퍼 최대 크기 (카운터 8 + ID 2 + 페이로드와 합쳐 255 이하)
+static const uint8_t MINIMAC_HOST_HIST_MAX = 255 - 10 - MINIMAC_HOST_MAX_DATA;
+
+/// 한 번에 웨이브로 나누는 프레임 수
+static const uint8_t MINIMAC_HOST_WINDOW = 64;
+
+/// 재동기화 프레임 CAN ID (장치의 MINIMAC_RESYNC_ID와 같은 값)
+static const uint16_t MINIMAC_HOST_RESYNC_ID = 0x7F0;
+
+/// 재동기화 프레임 페이로드 길이: CAN ID 11비트 ‖ 카운터 하위 21비트
+static const uint8_t MINIMAC_HOST_RESYNC_LEN = 4;
+
+/// CAN ID 하나의 호스트 검증 상태
+typedef struct {
+  MiniMacMbKey key;    ///< HMAC-MD5 키 중간 상태
+  uint64_t counter;    ///< 64비트 메시지 카운터
+  uint16_t id;         ///< CAN ID
+  uint8_t tag_len;     ///< 태그 길이(Byte, 1..16)
+  uint8_t lambda;      ///< 메시지 히스토리 길이 λ
+  uint8_t hist_bytes;  ///< 히스토리 링 버퍼 크기 (장치의 HistBytes)
+  uint8_t hist_cnt;    ///< 히스토리 항목 수 (≤ λ)
+  uint8_t hist_used;   ///< 사용량 (장치와 같이 Σ 1 + len)
+  uint8_t hist_data;   ///< hist에 든 페이로드 바이트 수 (Σ len)
+  uint8_t hist_len[MINIMAC_HOST_HIST_MAX]; ///< 항목별 길이 (오래된 순)
+  uint8_t hist[MINIMAC_HOST_HIST_MAX];     ///< 페이로드 연결 (오래된 순)
+} MiniMacHostCtx;
+
+/// 일괄 검증할 프레임 하나
+typedef struct {
+  MiniMacHostCtx *ctx; ///< 이 프레임 CAN ID의 상태
+  const uint8_t *data; ///< 수신 데이터 (페이로드 ‖ 태그)
+  uint8_t len;         ///< 수신 길이(Byte, DLC)
+  bool resync;         ///< 재동기화 프레임(MINIMAC_HOST_RESYNC_ID)이면 true
+} MiniMacHostFrame;
+
+/**
+ * @brief CAN ID 하나의 호스트 검증 상태 초기화
+ * @param ctx        초기화할 상태
+ * @param can_id     CAN ID
+ * @param key        그룹 키
+ * @param key_len    키 길이(Byte, 1..64)
+ * @param tag_len    태그 길이(Byte, 1..16)
+ * @param lambda     히스토리 길이 λ (1..254)
+ * @param hist_bytes 히스토리 링 버퍼 크기 (장치와 같은 값, 0이면
+ *                   λ × (1 + MINIMAC_HOST_MAX_DATA))
+ * @return true  성공
+ * @return false 인자 범위 오류 (hist_bytes > MINIMAC_HOST_HIST_MAX 포함)
+ */
+bool minimac_host_init(MiniMacHostCtx *ctx, uint16_t can_id,
+                       const uint8_t *key, uint8_t key_len, uint8_t tag_len,
+                       uint8_t lambda, uint16_t hist_bytes);
+
+/**
+ * @brief 프레임 n개 일괄 검증
+ * @param frames  수신 순서대로 놓인 프레임 배열
+ * @param n       프레임 수
+ * @param results 프레임별 결과 (true: 검증 성공 및 상태 갱신)
+ *
+ * MINIMAC_HOST_WINDOW개씩 잘라, 각 창 안에서 아직 처리하지 않은 프레임 중
+ * CAN ID마다 가장 앞선 것 하나씩을 모아 웨이브 하나로 계산한다. 같은
+ * ID가 많을수록 웨이브가 작아지며, 한 ID만 오면 프레임 하나씩 처리한다.
+ * 길이가 태그보다 짧거나 페이로드가 MINIMAC_HOST_MAX_DATA를 넘으면 실패이다.
+ *
+ * 재동기화 프레임은 같은 ID의 데이터 프레임과 순서를 지키며, 길이가
+ * MINIMAC_HOST_RESYNC_LEN + 태그 길이이고 페이로드의 ID가 ctx의 ID 하위
+ * 11비트와 같아야 한다. 카운터는 현재 값 이상에서 하위 21비트가 같은 가장
+ * 작은 값으로 복원하고, 태그는 카운터 ‖ (ID | 0x8000) ‖ 페이로드의 MAC이다.
+ * 성공하면 카운터는 복원한 값 + 1, 히스토리는 빈 상태가 된다.
+ */
+void minimac_host_verify_batch(const MiniMacHostFrame *frames, size_t n,
+                               bool *results);
+
+/**
+ * @brief 재동기화 프레임이 가리키는 CAN ID
+ * @param data 재동기화 프레임 데이터
+ * @param len  수신 길이(Byte)
+ * @return 페이로드 상위 11비트의 CAN ID, 페이로드보다 짧으면 0xFFFF
+ */
+uint16_t minimac_host_resync_id(const uint8_t *data, uint8_t len);
+
+#endif // MINIMAC_HOST_H
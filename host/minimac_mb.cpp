@@ -0,0 +1,339 @@
+/**
+ * @file minimac_mb.cpp
+ * @brief 다중 버퍼 SIMD HMAC-MD5 구현 (SSE2/AVX2/AVX-512, 실행 시 선택)
+ *
+ * MD5 압축 함수 하나를 레인 타입 V에 대한 템플릿으로 쓰고, ISA마다 target
+ * 속성을 붙인 진입 함수 안에 인라인해 그 ISA의 벡터 명령으로 만든다. V는
+ * GCC/Clang 벡터 확장 타입(레인마다 uint32_t)이며 스칼라 경로는 uint32_t
+ * 그대로이다.
+ */
+
+#include "minimac_mb.h"
+
+#include <string.h>
+
+#define MB_INLINE static inline __attribute__((always_inline))
+
+/// 레인 수별 벡터 타입
+typedef uint32_t mb_v4 __attribute__((vector_size(16)));
+typedef uint32_t mb_v8 __attribute__((vector_size(32)));
+typedef uint32_t mb_v16 __attribute__((vector_size(64)));
+
+/// 내부 해시 최대 블록 수 (키 패드 블록 제외, 입력 255바이트 + 패딩 9바이트)
+static const unsigned MB_MAX_BLOCKS = (255 + 9 + 63) / 64;
+
+/// MD5 블록 크기(Byte)
+static const unsigned MB_BLOCK_LEN = 64;
+
+/// 리틀 엔디언 32비트 읽기
+MB_INLINE uint32_t mb_load32(const uint8_t *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+/// 리틀 엔디언 32비트 쓰기
+MB_INLINE void mb_store32(uint8_t *p, uint32_t x) {
+  p[0] = (uint8_t)x;
+  p[1] = (uint8_t)(x >> 8);
+  p[2] = (uint8_t)(x >> 16);
+  p[3] = (uint8_t)(x >> 24);
+}
+
+/*
+ * 벡터 값을 주고받는 함수는 target 속성이 없는 곳에서 ABI 경고(-Wpsabi)를
+ * 내므로, 레인 연산은 매크로로 두고 함수에는 배열(포인터)만 넘긴다.
+ */
+
+/// 레인별 n비트 왼쪽 회전 (AVX-512에서는 vprold 한 개)
+#define MB_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/* 라운드 함수 (장치 쪽 minimac_md5.cpp와 같은 동치식) */
+#define MB_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MB_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MB_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MB_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+/* 한 단계: a = b + ((a + f(b, c, d) + X[k] + T) <<< s) */
+#define MB_STEP(f, a, b, c, d, k, t, s)                                        \
+  (a) += f((b), (c), (d)) + w[k] + (uint32_t)(t);                              \
+  (a) = MB_ROTL(a, s) + (b)
+
+/**
+ * @brief 레인마다 독립인 MD5 압축 (64단계 전개)
+ * @param st 레인별 체이닝 값 a, b, c, d (입출력)
+ * @param w  레인별 메시지 워드 X[0..15]
+ */
+template <typename V> MB_INLINE void mb_compress(V st[4], const V w[16]) {
+  V a = st[0], b = st[1], c = st[2], d = st[3];
+
+  MB_STEP(MB_F, a, b, c, d, 0, 0xd76aa478, 7);
+  MB_STEP(MB_F, d, a, b, c, 1, 0xe8c7b756, 12);
+  MB_STEP(MB_F, c, d, a, b, 2, 0x242070db, 17);
+  MB_STEP(MB_F, b, c, d, a, 3, 0xc1bdceee, 22);
+  MB_STEP(MB_F, a, b, c, d, 4, 0xf57c0faf, 7);
+  MB_STEP(MB_F, d, a, b, c, 5, 0x4787c62a, 12);
+  MB_STEP(MB_F, c, d, a, b, 6, 0xa8304613, 17);
+  MB_STEP(MB_F, b, c, d, a, 7, 0xfd469501, 22);
+  MB_STEP(MB_F, a, b, c, d, 8, 0x698098d8, 7);
+  MB_STEP(MB_F, d, a, b, c, 9, 0x8b44f7af, 12);
+  MB_STEP(MB_F, c, d, a, b, 10, 0xffff5bb1, 17);
+  MB_STEP(MB_F, b, c, d, a, 11, 0x895cd7be, 22);
+  MB_STEP(MB_F, a, b, c, d, 12, 0x6b901122, 7);
+  MB_STEP(MB_F, d, a, b, c, 13, 0xfd987193, 12);
+  MB_STEP(MB_F, c, d, a, b, 14, 0xa679438e, 17);
+  MB_STEP(MB_F, b, c, d, a, 15, 0x49b40821, 22);
+
+  MB_STEP(MB_G, a, b, c, d, 1, 0xf61e2562, 5);
+  MB_STEP(MB_G, d, a, b, c, 6, 0xc040b340, 9);
+  MB_STEP(MB_G, c, d, a, b, 11, 0x265e5a51, 14);
+  MB_STEP(MB_G, b, c, d, a, 0, 0xe9b6c7aa, 20);
+  MB_STEP(MB_G, a, b, c, d, 5, 0xd62f105d, 5);
+  MB_STEP(MB_G, d, a, b, c, 10, 0x02441453, 9);
+  MB_STEP(MB_G, c, d, a, b, 15, 0xd8a1e681, 14);
+  MB_STEP(MB_G, b, c, d, a, 4, 0xe7d3fbc8, 20);
+  MB_STEP(MB_G, a, b, c, d, 9, 0x21e1cde6, 5);
+  MB_STEP(MB_G, d, a, b, c, 14, 0xc33707d6, 9);
+  MB_STEP(MB_G, c, d, a, b, 3, 0xf4d50d87, 14);
+  MB_STEP(MB_G, b, c, d, a, 8, 0x455a14ed, 20);
+  MB_STEP(MB_G, a, b, c, d, 13, 0xa9e3e905, 5);
+  MB_STEP(MB_G, d, a, b, c, 2, 0xfcefa3f8, 9);
+  MB_STEP(MB_G, c, d, a, b, 7, 0x676f02d9, 14);
+  MB_STEP(MB_G, b, c, d, a, 12, 0x8d2a4c8a, 20);
+
+  MB_STEP(MB_H, a, b, c, d, 5, 0xfffa3942, 4);
+  MB_STEP(MB_H, d, a, b, c, 8, 0x8771f681, 11);
+  MB_STEP(MB_H, c, d, a, b, 11, 0x6d9d6122, 16);
+  MB_STEP(MB_H, b, c, d, a, 14, 0xfde5380c, 23);
+  MB_STEP(MB_H, a, b, c, d, 1, 0xa4beea44, 4);
+  MB_STEP(MB_H, d, a, b, c, 4, 0x4bdecfa9, 11);
+  MB_STEP(MB_H, c, d, a, b, 7, 0xf6bb4b60, 16);
+  MB_STEP(MB_H, b, c, d, a, 10, 0xbebfbc70, 23);
+  MB_STEP(MB_H, a, b, c, d, 13, 0x289b7ec6, 4);
+  MB_STEP(MB_H, d, a, b, c, 0, 0xeaa127fa, 11);
+  MB_STEP(MB_H, c, d, a, b, 3, 0xd4ef3085, 16);
+  MB_STEP(MB_H, b, c, d, a, 6, 0x04881d05, 23);
+  MB_STEP(MB_H, a, b, c, d, 9, 0xd9d4d039, 4);
+  MB_STEP(MB_H, d, a, b, c, 12, 0xe6db99e5, 11);
+  MB_STEP(MB_H, c, d, a, b, 15, 0x1fa27cf8, 16);
+  MB_STEP(MB_H, b, c, d, a, 2, 0xc4ac5665, 23);
+
+  MB_STEP(MB_I, a, b, c, d, 0, 0xf4292244, 6);
+  MB_STEP(MB_I, d, a, b, c, 7, 0x432aff97, 10);
+  MB_STEP(MB_I, c, d, a, b, 14, 0xab9423a7, 15);
+  MB_STEP(MB_I, b, c, d, a, 5, 0xfc93a039, 21);
+  MB_STEP(MB_I, a, b, c, d, 12, 0x655b59c3, 6);
+  MB_STEP(MB_I, d, a, b, c, 3, 0x8f0ccc92, 10);
+  MB_STEP(MB_I, c, d, a, b, 10, 0xffeff47d, 15);
+  MB_STEP(MB_I, b, c, d, a, 1, 0x85845dd1, 21);
+  MB_STEP(MB_I, a, b, c, d, 8, 0x6fa87e4f, 6);
+  MB_STEP(MB_I, d, a, b, c, 15, 0xfe2ce6e0, 10);
+  MB_STEP(MB_I, c, d, a, b, 6, 0xa3014314, 15);
+  MB_STEP(MB_I, b, c, d, a, 13, 0x4e0811a1, 21);
+  MB_STEP(MB_I, a, b, c, d, 4, 0xf7537e82, 6);
+  MB_STEP(MB_I, d, a, b, c, 11, 0xbd3af235, 10);
+  MB_STEP(MB_I, c, d, a, b, 2, 0x2ad7d2bb, 15);
+  MB_STEP(MB_I, b, c, d, a, 9, 0xeb86d391, 21);
+
+  st[0] += a;
+  st[1] += b;
+  st[2] += c;
+  st[3] += d;
+}
+
+/**
+ * @brief 레인 L개 이하의 작업 묶음 하나 처리
+ * @param jobs  작업 배열
+ * @param lanes 실제 작업 수 (≤ L, 나머지 레인은 jobs[0]을 다시 계산)
+ *
+ * (1) 레인마다 입력을 MD5 패딩까지 붙여 블록 단위로 펼치고, (2) 키 패드
+ * 중간 상태(istate)에서 블록 b를 모든 레인에 한 번에 압축하되 블록 수가
+ * b 이하인 레인은 마스크로 이전 상태를 유지한다. (3) 내부 다이제스트는
+ * 체이닝 값 워드 그대로 외부 해시의 메시지 워드가 되므로 패딩 워드만 채워
+ * ostate에서 한 번 더 압축하고, (4) 레인별 결과를 작업에 되돌린다.
+ */
+template <typename V, unsigned L>
+MB_INLINE void mb_group(MiniMacMbJob *jobs, unsigned lanes) {
+  uint8_t buf[L][MB_MAX_BLOCKS * MB_BLOCK_LEN];
+  unsigned nb[L], max_nb = 0;
+  uint32_t lw[16][L];
+  V st[4], w[16], zero = {};
+
+  /* (1) 레인별 입력 + 0x80 + 0 + 비트 길이(키 패드 블록 포함) */
+  for (unsigned i = 0; i < L; i++) {
+    const MiniMacMbJob *j = &jobs[i < lanes ? i : 0];
+    unsigned len = j->len;
+    nb[i] = (len + 9 + MB_BLOCK_LEN - 1) / MB_BLOCK_LEN;
+    if (nb[i] > max_nb)
+      max_nb = nb[i];
+
+    uint8_t *p = buf[i];
+    memcpy(p, j->msg, len);
+    p[len] = 0x80;
+    memset(p + len + 1, 0, nb[i] * MB_BLOCK_LEN - 8 - (len + 1));
+    uint64_t bits = (uint64_t)(MB_BLOCK_LEN + len) << 3;
+    mb_store32(p + nb[i] * MB_BLOCK_LEN - 8, (uint32_t)bits);
+    mb_store32(p + nb[i] * MB_BLOCK_LEN - 4, (uint32_t)(bits >> 32));
+  }
+
+  /* (2) 내부 해시: istate에서 시작해 블록 단위로 레인 동시 압축 */
+  for (unsigned r = 0; r < 4; r++) {
+    for (unsigned i = 0; i < L; i++)
+      lw[r][i] = jobs[i < lanes ? i : 0].key->istate[r];
+    memcpy(&st[r], lw[r], sizeof(V));
+  }
+  for (unsigned b = 0; b < max_nb; b++) {
+    for (unsigned k = 0; k < 16; k++) {
+      for (unsigned i = 0; i < L; i++)
+        lw[k][i] = mb_load32(buf[i] + b * MB_BLOCK_LEN + 4 * k);
+      memcpy(&w[k], lw[k], sizeof(V));
+    }
+    V t[4] = {st[0], st[1], st[2], st[3]};
+    mb_compress(t, w);
+
+    uint32_t m[L];
+    for (unsigned i = 0; i < L; i++)
+      m[i] = b < nb[i] ? 0xFFFFFFFF : 0;
+    V mask;
+    memcpy(&mask, m, sizeof(V));
+    for (unsigned r = 0; r < 4; r++)
+      st[r] = (t[r] & mask) | (st[r] & ~mask);
+  }
+
+  /* (3) 외부 해시: 내부 다이제스트(16바이트) + 패딩, 길이 (64 + 16) × 8 */
+  for (unsigned r = 0; r < 4; r++)
+    w[r] = st[r];
+  w[4] = zero + 0x80;
+  for (unsigned k = 5; k < 16; k++)
+    w[k] = zero;
+  w[14] = zero + ((MB_BLOCK_LEN + 16) << 3);
+  for (unsigned r = 0; r < 4; r++) {
+    for (unsigned i = 0; i < L; i++)
+      lw[r][i] = jobs[i < lanes ? i : 0].key->ostate[r];
+    memcpy(&st[r], lw[r], sizeof(V));
+  }
+  mb_compress(st, w);
+
+  /* (4) 레인별 다이제스트 기록 */
+  for (unsigned r = 0; r < 4; r++)
+    memcpy(lw[r], &st[r], sizeof(V));
+  for (unsigned i = 0; i < lanes; i++)
+    for (unsigned r = 0; r < 4; r++)
+      mb_store32(jobs[i].digest + 4 * r, lw[r][i]);
+}
+
+/**
+ * @brief 작업 배열을 L개씩 묶어 처리
+ */
+template <typename V, unsigned L>
+MB_INLINE void mb_run(MiniMacMbJob *jobs, size_t n) {
+  for (size_t base = 0; base < n; base += L)
+    mb_group<V, L>(jobs + base, n - base < L ? (unsigned)(n - base) : L);
+}
+
+/* ---- ISA별 진입 함수 ---- */
+
+typedef void (*mb_fn)(MiniMacMbJob *jobs, size_t n);
+
+static void mb_scalar(MiniMacMbJob *jobs, size_t n) {
+  mb_run<uint32_t, 1>(jobs, n);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) static void mb_sse2(MiniMacMbJob *jobs,
+                                                    size_t n) {
+  mb_run<mb_v4, 4>(jobs, n);
+}
+
+__attribute__((target("avx2"))) static void mb_avx2(MiniMacMbJob *jobs,
+                                                    size_t n) {
+  mb_run<mb_v8, 8>(jobs, n);
+}
+
+__attribute__((target("avx512f"))) static void mb_avx512(MiniMacMbJob *jobs,
+                                                         size_t n) {
+  mb_run<mb_v16, 16>(jobs, n);
+}
+
+static bool mb_has_sse2(void) { return __builtin_cpu_supports("sse2"); }
+static bool mb_has_avx2(void) { return __builtin_cpu_supports("avx2"); }
+static bool mb_has_avx512(void) { return __builtin_cpu_supports("avx512f"); }
+#else
+/// x86이 아니면 4레인 일반 벡터 (NEON 등 컴파일러가 아는 SIMD로 변환)
+static void mb_vec4(MiniMacMbJob *jobs, size_t n) { mb_run<mb_v4, 4>(jobs, n); }
+#endif
+
+static bool mb_always(void) { return true; }
+
+/// 구현 목록 (우선순위 순)
+static const struct {
+  const char *name;     ///< 구현 이름
+  mb_fn fn;             ///< 진입 함수
+  bool (*usable)(void); ///< 이 CPU에서 쓸 수 있는지
+} MB_IMPLS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx512", mb_avx512, mb_has_avx512},
+    {"avx2", mb_avx2, mb_has_avx2},
+    {"sse2", mb_sse2, mb_has_sse2},
+#else
+    {"vec4", mb_vec4, mb_always},
+#endif
+    {"scalar", mb_scalar, mb_always},
+};
+
+static const unsigned MB_IMPL_CNT = sizeof(MB_IMPLS) / sizeof(MB_IMPLS[0]);
+
+/// 선택된 구현 번호 (-1이면 아직 선택 전)
+static int mb_impl = -1;
+
+/**
+ * @brief 이 CPU에서 쓸 수 있는 가장 넓은 구현 선택 (첫 호출 시 1회)
+ */
+static int mb_pick(void) {
+  if (mb_impl < 0) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+#endif
+    unsigned i = 0;
+    while (!MB_IMPLS[i].usable())
+      i++;
+    mb_impl = (int)i;
+  }
+  return mb_impl;
+}
+
+void minimac_mb_key(MiniMacMbKey *k, const uint8_t *key, uint8_t key_len) {
+  static const uint32_t iv[4] = {0x67452301, 0xefcdab89, 0x98badcfe,
+                                 0x10325476};
+  uint8_t block[MB_BLOCK_LEN];
+  uint32_t w[16];
+
+  for (unsigned p = 0; p < 2; p++) {
+    uint32_t *st = p ? k->ostate : k->istate;
+    memset(block, p ? 0x5C : 0x36, sizeof(block));
+    for (unsigned i = 0; i < key_len; i++)
+      block[i] ^= key[i];
+    for (unsigned i = 0; i < 16; i++)
+      w[i] = mb_load32(block + 4 * i);
+    memcpy(st, iv, sizeof(iv));
+    mb_compress(st, w);
+  }
+  memset(block, 0, sizeof(block));
+  memset(w, 0, sizeof(w));
+}
+
+void minimac_mb_hmac_md5(MiniMacMbJob *jobs, size_t n) {
+  MB_IMPLS[mb_pick()].fn(jobs, n);
+}
+
+const char *minimac_mb_isa(void) { return MB_IMPLS[mb_pick()].name; }
+
+bool minimac_mb_select(const char *isa) {
+  mb_pick();
+  for (unsigned i = 0; i < MB_IMPL_CNT; i++) {
+    if (strcmp(MB_IMPLS[i].name, isa) == 0 && MB_IMPLS[i].usable()) {
+      mb_impl = (int)i;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file minimac_mb.h
+ * @brief 호스트(리눅스 게이트웨이)용 다중 버퍼 SIMD HMAC-MD5
+ *
+ * 게이트웨이에서 Mini-MAC 검증을 돌리면 프레임마다 독립적인 HMAC-MD5를
+ * 짧은 입력(카운터 ‖ CAN ID ‖ 히스토리 ‖ 페이로드)에 대해 계산합니다. 이
+ * 모듈은 서로 다른 프레임 여러 개를 SIMD 레인 하나씩에 배정해 MD5 압축을
+ * 동시에 돌립니다(SSE2 4개, AVX2 8개, AVX-512 16개). 사용할 명령어 집합은
+ * 첫 호출 때 CPU를 검사해 고르며, x86이 아니면 4레인 일반 벡터(NEON 등)
+ * 또는 스칼라 경로를 씁니다.
+ *
+ * 키 패드 블록은 장치 쪽과 같이 미리 압축해 둔 중간 상태(MiniMacMbKey)에서
+ * 시작하므로 프레임당 압축은 내부 해시 1..2회와 외부 해시 1회입니다.
+ * 결과는 장치의 HMAC-MD5 백엔드, ArduinoMD5의 MD5::hmac_md5()와 같습니다.
+ *
+ * 빌드 시스템 없이 다음처럼 컴파일합니다. ISA별 코드는 함수 단위 target
+ * 속성으로 만들어지므로 -mavx2 같은 옵션이 필요 없습니다.
+ * @code
+ * g++ -O2 -std=gnu++11 -c minimac_mb.cpp minimac_host.cpp
+ * @endcode
+ *
+ * 구현별 시험 벡터와 일괄 검증 비교 시험 프로그램은 minimac_mb_test.cpp입니다.
+ */
+#ifndef MINIMAC_MB_H
+#define MINIMAC_MB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// 한 번에 처리하는 최대 레인 수 (AVX-512)
+static const uint8_t MINIMAC_MB_MAX_LANES = 16;
+
+/// HMAC-MD5 키 중간 상태 ((K ⊕ ipad), (K ⊕ opad) 블록 압축 결과)
+typedef struct {
+  uint32_t istate[4]; ///< (K ⊕ ipad) 흡수 후 MD5 상태
+  uint32_t ostate[4]; ///< (K ⊕ opad) 흡수 후 MD5 상태
+} MiniMacMbKey;
+
+/// 다중 버퍼 HMAC-MD5 작업 하나 (프레임 하나)
+typedef struct {
+  const MiniMacMbKey *key; ///< 이 프레임 CAN ID의 키 중간 상태
+  const uint8_t *msg;      ///< 다이제스트 입력
+  uint8_t len;             ///< 입력 길이(Byte)
+  uint8_t digest[16];      ///< 결과 다이제스트 (출력)
+} MiniMacMbJob;
+
+/**
+ * @brief HMAC-MD5 키 중간 상태 계산
+ * @param k       결과 저장 위치
+ * @param key     그룹 키
+ * @param key_len 키 길이(Byte, ≤ 64)
+ */
+void minimac_mb_key(MiniMacMbKey *k, const uint8_t *key, uint8_t key_len);
+
+/**
+ * @brief 작업 n개의 HMAC-MD5를 SIMD 레인에 나눠 계산
+ * @param jobs 작업 배열 (digest가 채워짐)
+ * @param n    작업 수
+ *
+ * 레인 수 단위로 묶어 처리하고, 마지막 묶음의 빈 레인은 계산만 하고
+ * 버린다. 입력 길이가 달라 내부 해시 블록 수가 다른 레인은 마스크로
+ * 자기 블록 수만큼만 상태를 갱신한다.
+ */
+void minimac_mb_hmac_md5(MiniMacMbJob *jobs, size_t n);
+
+/**
+ * @brief 현재 선택된 구현 이름
+ * @return "avx512", "avx2", "sse2", "vec4" 또는 "scalar"
+ */
+const char *minimac_mb_isa(void);
+
+/**
+ * @brief 구현을 이름으로 강제 선택 (벤치마크, 비교 시험용)
+ * @param isa minimac_mb_isa()가 돌려주는 이름 중 하나
+ * @return true  선택됨
+ * @return false 이 CPU/빌드에서 쓸 수 없는 이름
+ */
+bool minimac_mb_select(const char *isa);
+
+#endif // MINIMAC_MB_H
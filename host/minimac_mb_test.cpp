@@ -0,0 +1,508 @@
+/**
+ * @file minimac_mb_test.cpp
+ * @brief 다중 버퍼 HMAC-MD5(minimac_mb)와 일괄 검증(minimac_host) 호스트 시험
+ *
+ * 이 CPU에서 쓸 수 있는 구현(avx512, avx2, sse2, vec4, scalar)마다 RFC 2202
+ * HMAC-MD5 벡터, 길이가 섞인 작업을 레인 수로 나누어떨어지지 않게 넣었을 때의
+ * 결과(빈 레인 마스킹), minimac_host_verify_batch()와 프레임을 하나씩
+ * 검증하는 순차 모델의 결과와 상태(재동기화 프레임 포함)를 비교합니다. 쓸 수
+ * 없는 구현은 건너뛰었다고 출력합니다. 실패한 항목을 출력하고 하나라도
+ * 실패하면 1을 반환합니다.
+ *
+ * @code
+ * g++ -O2 -std=gnu++11 -Wall -Wextra -I host host/minimac_mb_test.cpp \
+ *     host/minimac_mb.cpp host/minimac_host.cpp -o minimac_mb_test && \
+ *     ./minimac_mb_test
+ * @endcode
+ */
+
+#include "minimac_host.h"
+#include "minimac_mb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned fails; ///< 실패한 검사 수
+
+/**
+ * @brief 검사 하나 (실패하면 구현 이름과 함께 출력하고 계수)
+ */
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL [%s]: %s\n", minimac_mb_isa(), what);
+    fails++;
+  }
+}
+
+/**
+ * @brief 작업 하나를 스칼라 구현으로 계산 (비교 기준)
+ */
+static void scalar_hmac(MiniMacMbJob *job) {
+  const char *isa = minimac_mb_isa();
+  minimac_mb_select("scalar");
+  minimac_mb_hmac_md5(job, 1);
+  minimac_mb_select(isa);
+}
+
+/**
+ * @brief RFC 2202 HMAC-MD5 시험 벡터 (+ 5블록 입력 하나)
+ *
+ * 6, 7번은 키가 블록보다 길어 RFC대로 MD5(키)를 키로 쓴다. 마지막 항목은
+ * 입력 255바이트(내부 해시 5블록)로 Python hmac 모듈로 만든 값이다.
+ */
+static void test_rfc2202(void) {
+  static const uint8_t md5_aa80[16] = {0x8f, 0xb6, 0xab, 0x01, 0x84, 0x00,
+                                       0x23, 0xec, 0x45, 0x3e, 0xcd, 0xec,
+                                       0x73, 0xdc, 0x1b, 0x66};
+  static const char *const digests[8] = {
+      "9294727a3638bb1c13f48ef8158bfc9d", "750c783e6ab0b503eaa86e310a5db738",
+      "56be34521d144c88dbb8c733f0e8b3f6", "697eaf0aca3a3aea3a75164746ffaa79",
+      "56461ef2342edc00f9bab995690efd4c", "6b1ab7fe4bd7bf8f0b62e6ce61b9d0cd",
+      "6f630fad67cda0ee1fb1f562db3aa53e", "c17f72df0bb131d91194aa2e559038d4"};
+  uint8_t key[8][25], msg[8][255], key_len[8], msg_len[8];
+
+  memset(key[0], 0x0b, key_len[0] = 16);
+  memcpy(msg[0], "Hi There", msg_len[0] = 8);
+  memcpy(key[1], "Jefe", key_len[1] = 4);
+  memcpy(msg[1], "what do ya want for nothing?", msg_len[1] = 28);
+  memset(key[2], 0xaa, key_len[2] = 16);
+  memset(msg[2], 0xdd, msg_len[2] = 50);
+  for (uint8_t i = 0; i < 25; i++)
+    key[3][i] = i + 1;
+  key_len[3] = 25;
+  memset(msg[3], 0xcd, msg_len[3] = 50);
+  memset(key[4], 0x0c, key_len[4] = 16);
+  memcpy(msg[4], "Test With Truncation", msg_len[4] = 20);
+  memcpy(key[5], md5_aa80, key_len[5] = 16);
+  memcpy(msg[5], "Test Using Larger Than Block-Size Key - Hash Key First",
+         msg_len[5] = 54);
+  memcpy(key[6], md5_aa80, key_len[6] = 16);
+  memcpy(msg[6],
+         "Test Using Larger Than Block-Size Key and Larger Than One "
+         "Block-Size Data",
+         msg_len[6] = 73);
+  for (uint8_t i = 0; i < 16; i++)
+    key[7][i] = i + 1;
+  key_len[7] = 16;
+  for (unsigned i = 0; i < 255; i++)
+    msg[7][i] = (uint8_t)i;
+  msg_len[7] = 255;
+
+  /* 8개를 한 번에 넣어 레인마다 다른 벡터가 돌게 함 */
+  MiniMacMbKey keys[8];
+  MiniMacMbJob jobs[8];
+  for (unsigned v = 0; v < 8; v++) {
+    minimac_mb_key(&keys[v], key[v], key_len[v]);
+    jobs[v].key = &keys[v];
+    jobs[v].msg = msg[v];
+    jobs[v].len = msg_len[v];
+  }
+  minimac_mb_hmac_md5(jobs, 8);
+
+  for (unsigned v = 0; v < 8; v++) {
+    char hex[33];
+    for (unsigned i = 0; i < 16; i++)
+      sprintf(hex + 2 * i, "%02x", jobs[v].digest[i]);
+    check(strcmp(hex, digests[v]) == 0, "rfc2202: digest");
+  }
+}
+
+/**
+ * @brief 길이가 섞인 작업 1..40개: 빈 레인 마스킹과 뒤쪽 작업 보존
+ *
+ * 작업 수가 레인 수의 배수가 아니면 마지막 묶음의 빈 레인은 첫 작업을
+ * 복사해 계산만 하고 버린다. 입력 길이 0..255(내부 해시 2..5블록)가 한
+ * 묶음에 섞여도 레인마다 스칼라 결과와 같아야 하고, n번째 이후 작업의
+ * 다이제스트는 건드리지 않아야 한다.
+ */
+static void test_ragged(void) {
+  static uint8_t msg[41][255];
+  MiniMacMbKey keys[3];
+  MiniMacMbJob jobs[41], ref;
+
+  for (uint8_t k = 0; k < 3; k++) {
+    uint8_t key[16];
+    for (uint8_t i = 0; i < 16; i++)
+      key[i] = (uint8_t)(k * 16 + i);
+    minimac_mb_key(&keys[k], key, 16);
+  }
+  for (unsigned n = 1; n <= 40; n++) {
+    for (unsigned i = 0; i <= n; i++) {
+      jobs[i].key = &keys[(i + n) % 3];
+      jobs[i].msg = msg[i];
+      jobs[i].len = (uint8_t)((i * 53 + n * 31) % 256);
+      for (unsigned b = 0; b < jobs[i].len; b++)
+        msg[i][b] = (uint8_t)(rand());
+      memset(jobs[i].digest, 0xA5, sizeof(jobs[i].digest));
+    }
+    minimac_mb_hmac_md5(jobs, n);
+
+    for (unsigned i = 0; i < n; i++) {
+      ref = jobs[i];
+      scalar_hmac(&ref);
+      check(memcmp(ref.digest, jobs[i].digest, 16) == 0, "ragged: lane digest");
+    }
+    uint8_t untouched[16];
+    memset(untouched, 0xA5, sizeof(untouched));
+    check(memcmp(jobs[n].digest, untouched, 16) == 0, "ragged: job past n");
+  }
+}
+
+/// 순차 검증 모델: CAN ID 하나의 송신 또는 수신 상태 (MiniMac::verify()와 같은 규칙)
+typedef struct {
+  MiniMacMbKey key;
+  uint64_t counter;
+  uint16_t id;
+  uint8_t tag_len, lambda, hist_bytes;
+  uint8_t cnt, used;
+  uint8_t len[MINIMAC_HOST_HIST_MAX];
+  uint8_t data[MINIMAC_HOST_HIST_MAX][MINIMAC_HOST_MAX_DATA];
+} SeqNode;
+
+static void seq_init(SeqNode *s, uint16_t id, const uint8_t *key,
+                     uint8_t tag_len, uint8_t lambda, uint8_t hist_bytes) {
+  memset(s, 0, sizeof(*s));
+  minimac_mb_key(&s->key, key, 16);
+  s->id = id;
+  s->tag_len = tag_len;
+  s->lambda = lambda;
+  s->hist_bytes = hist_bytes;
+}
+
+/// 가장 오래된 항목 삭제
+static void seq_drop(SeqNode *s) {
+  s->used -= 1 + s->len[0];
+  s->cnt--;
+  memmove(s->len, s->len + 1, s->cnt);
+  memmove(s->data, s->data + 1, s->cnt * sizeof(s->data[0]));
+}
+
+/// 히스토리 추가: λ개가 찼거나 링 버퍼가 모자라면 오래된 것부터 삭제
+static void seq_push(SeqNode *s, const uint8_t *data, uint8_t len) {
+  if (s->cnt == s->lambda)
+    seq_drop(s);
+  while (s->used + 1 + len > s->hist_bytes)
+    seq_drop(s);
+  memcpy(s->data[s->cnt], data, len);
+  s->len[s->cnt++] = len;
+  s->used += 1 + len;
+}
+
+/// 카운터(BE 8) ‖ ID(BE 2) ‖ 히스토리 ‖ 페이로드의 HMAC-MD5 (스칼라)
+static void seq_digest(const SeqNode *s, const uint8_t *data, uint8_t len,
+                       uint8_t *digest) {
+  uint8_t msg[255], n = 0;
+  for (int i = 7; i >= 0; i--)
+    msg[n++] = (uint8_t)(s->counter >> (8 * i));
+  msg[n++] = (uint8_t)(s->id >> 8);
+  msg[n++] = (uint8_t)s->id;
+  for (uint8_t h = 0; h < s->cnt; h++) {
+    memcpy(msg + n, s->data[h], s->len[h]);
+    n += s->len[h];
+  }
+  memcpy(msg + n, data, len);
+  MiniMacMbJob job = {&s->key, msg, (uint8_t)(n + len), {0}};
+  scalar_hmac(&job);
+  memcpy(digest, job.digest, 16);
+}
+
+/// 서명: 페이로드 뒤에 태그를 붙이고 상태 갱신, 전송 길이 반환
+static uint8_t seq_sign(SeqNode *s, uint8_t *data, uint8_t len) {
+  uint8_t d[16];
+  seq_digest(s, data, len, d);
+  memcpy(data + len, d, s->tag_len);
+  seq_push(s, data, len);
+  s->counter++;
+  return (uint8_t)(len + s->tag_len);
+}
+
+/// 검증: 성공하면 상태 갱신
+static bool seq_verify(SeqNode *s, const uint8_t *data, uint8_t len) {
+  uint8_t d[16];
+  if (len < s->tag_len || len - s->tag_len > MINIMAC_HOST_MAX_DATA)
+    return false;
+  uint8_t payload_len = len - s->tag_len;
+  seq_digest(s, data, payload_len, d);
+  if (memcmp(d, data + payload_len, s->tag_len) != 0)
+    return false;
+  seq_push(s, data, payload_len);
+  s->counter++;
+  return true;
+}
+
+/// 재동기화 다이제스트: 카운터(BE 8) ‖ (ID | 0x8000)(BE 2) ‖ 페이로드 4바이트
+static void seq_resync_digest(const SeqNode *s, uint64_t ctr,
+                              const uint8_t *payload, uint8_t *digest) {
+  uint8_t msg[10 + MINIMAC_HOST_RESYNC_LEN], n = 0;
+  for (int i = 7; i >= 0; i--)
+    msg[n++] = (uint8_t)(ctr >> (8 * i));
+  msg[n++] = (uint8_t)((s->id | 0x8000) >> 8);
+  msg[n++] = (uint8_t)s->id;
+  memcpy(msg + n, payload, MINIMAC_HOST_RESYNC_LEN);
+  MiniMacMbJob job = {&s->key, msg, sizeof(msg), {0}};
+  scalar_hmac(&job);
+  memcpy(digest, job.digest, 16);
+}
+
+/// 재동기화 프레임 송신 (MiniMac::resync_prepare() + resync_commit())
+static uint8_t seq_resync_sign(SeqNode *s, uint8_t *buf) {
+  uint32_t w =
+      (uint32_t)(s->id & 0x7FF) << 21 | ((uint32_t)s->counter & 0x1FFFFF);
+  for (int i = MINIMAC_HOST_RESYNC_LEN - 1; i >= 0; i--, w >>= 8)
+    buf[i] = (uint8_t)w;
+  uint8_t d[16];
+  seq_resync_digest(s, s->counter, buf, d);
+  memcpy(buf + MINIMAC_HOST_RESYNC_LEN, d, s->tag_len);
+  s->counter++;
+  s->cnt = s->used = 0;
+  return (uint8_t)(MINIMAC_HOST_RESYNC_LEN + s->tag_len);
+}
+
+/// 재동기화 프레임 수신 (MiniMac::resync())
+static bool seq_resync(SeqNode *s, const uint8_t *data, uint8_t len) {
+  if (len != MINIMAC_HOST_RESYNC_LEN + s->tag_len ||
+      (uint16_t)(data[0] << 3 | data[1] >> 5) != (s->id & 0x7FF))
+    return false;
+  uint32_t w = 0;
+  for (uint8_t i = 0; i < MINIMAC_HOST_RESYNC_LEN; i++)
+    w = w << 8 | data[i];
+  uint64_t ctr = s->counter + ((w - (uint32_t)s->counter) & 0x1FFFFF);
+  uint8_t d[16];
+  seq_resync_digest(s, ctr, data, d);
+  if (memcmp(d, data + MINIMAC_HOST_RESYNC_LEN, s->tag_len) != 0)
+    return false;
+  s->counter = ctr + 1;
+  s->cnt = s->used = 0;
+  return true;
+}
+
+/// 호스트 상태가 순차 모델 수신 상태와 같은지
+static bool same_state(const MiniMacHostCtx *h, const SeqNode *s) {
+  if (h->counter != s->counter || h->hist_cnt != s->cnt ||
+      h->hist_used != s->used)
+    return false;
+  const uint8_t *p = h->hist;
+  for (uint8_t i = 0; i < s->cnt; i++) {
+    if (h->hist_len[i] != s->len[i] || memcmp(p, s->data[i], s->len[i]))
+      return false;
+    p += s->len[i];
+  }
+  return true;
+}
+
+/// 일괄 검증 시험 프레임 수
+static const unsigned BATCH_FRAMES = 1500;
+
+/**
+ * @brief minimac_host_verify_batch()와 순차 검증의 결과·상태 비교
+ *
+ * 태그 길이, λ, 링 버퍼 크기가 다른 ID 4개의 프레임을 섞고, 위조(태그
+ * 비트 반전), 재전송, 길이 오류 프레임을 끼워 넣는다. 크기가 제각각인
+ * 묶음으로 나눠 넘겨 MINIMAC_HOST_WINDOW 경계와 한 웨이브에 같은 ID가
+ * 여러 번 오는 경우를 모두 지나게 한다.
+ */
+static void test_batch(void) {
+  static const uint16_t ids[4] = {0x100, 0x123, 0x2A0, 0x7EF};
+  static const uint8_t tag_len[4] = {4, 2, 8, 16}, lambda[4] = {5, 1, 12, 3};
+  static const uint8_t hist_bytes[4] = {0, 0, 60, 0};
+  static uint8_t data[BATCH_FRAMES][MINIMAC_HOST_MAX_DATA + 16];
+  static MiniMacHostFrame frames[BATCH_FRAMES];
+  static bool expect[BATCH_FRAMES], results[BATCH_FRAMES];
+  static SeqNode tx[4], rx[4];
+  static MiniMacHostCtx host[4];
+  uint8_t key[16];
+
+  for (unsigned i = 0; i < 4; i++) {
+    for (uint8_t b = 0; b < 16; b++)
+      key[b] = (uint8_t)(ids[i] + b);
+    uint8_t hb = hist_bytes[i] ? hist_bytes[i]
+                               : lambda[i] * (1 + MINIMAC_HOST_MAX_DATA);
+    seq_init(&tx[i], ids[i], key, tag_len[i], lambda[i], hb);
+    seq_init(&rx[i], ids[i], key, tag_len[i], lambda[i], hb);
+    check(minimac_host_init(&host[i], ids[i], key, 16, tag_len[i], lambda[i],
+                            hist_bytes[i]),
+          "batch: init");
+  }
+
+  /* (1) 프레임 만들기: 정상 서명 사이에 위조, 재전송, 길이 오류 */
+  unsigned n = 0;
+  while (n + 2 <= BATCH_FRAMES) {
+    unsigned i = rand() % 4, kind = rand() % 16;
+    uint8_t *d = data[n];
+    uint8_t payload_len = (uint8_t)(rand() % (MINIMAC_HOST_MAX_DATA + 1));
+    for (uint8_t b = 0; b < payload_len; b++)
+      d[b] = (uint8_t)rand();
+    frames[n].ctx = &host[i];
+    frames[n].data = d;
+    frames[n].resync = false;
+    if (kind == 0) {
+      /* 태그보다 짧은 프레임 (서명하지 않음) */
+      frames[n].len = (uint8_t)(tag_len[i] - 1);
+      expect[n++] = false;
+      continue;
+    }
+    frames[n].len = seq_sign(&tx[i], d, payload_len);
+    if (kind == 1) {
+      /* 태그 비트를 뒤집은 위조가 먼저 도착 */
+      memcpy(data[n + 1], d, frames[n].len);
+      frames[n + 1] = frames[n];
+      frames[n + 1].data = data[n + 1];
+      d[frames[n].len - 1] ^= 0x01;
+      expect[n++] = false;
+    }
+    expect[n++] = true;
+    if (kind == 2) {
+      /* 재전송 */
+      frames[n] = frames[n - 1];
+      expect[n++] = false;
+    }
+  }
+
+  /* (2) 순차 모델: 프레임을 하나씩 검증 */
+  for (unsigned k = 0; k < n; k++) {
+    unsigned i = (unsigned)(frames[k].ctx - host);
+    check(seq_verify(&rx[i], frames[k].data, frames[k].len) == expect[k],
+          "batch: sequential result");
+  }
+
+  /* (3) 일괄 검증: 크기가 제각각인 묶음으로 나눠 넘김 */
+  for (unsigned k = 0; k < n;) {
+    unsigned cnt = 1 + rand() % (2 * MINIMAC_HOST_WINDOW + 10);
+    if (cnt > n - k)
+      cnt = n - k;
+    minimac_host_verify_batch(frames + k, cnt, results + k);
+    k += cnt;
+  }
+  for (unsigned k = 0; k < n; k++)
+    check(results[k] == expect[k], "batch: result");
+  for (unsigned i = 0; i < 4; i++)
+    check(same_state(&host[i], &rx[i]), "batch: counter and history");
+}
+
+/// 재동기화 시험 프레임 수
+static const unsigned RESYNC_FRAMES = 1200;
+
+/**
+ * @brief 재동기화 프레임을 지나는 일괄 검증
+ *
+ * 송신 측이 보낸 프레임 일부를 빠뜨려 수신 상태를 어긋나게 한 뒤
+ * 재동기화 프레임으로 다시 맞춘다. 카운터는 하위 21비트가 넘어가는
+ * 지점에서 시작하고, 재동기화 프레임의 위조, 재전송, 다른 ID 상태로 넘긴
+ * 경우를 끼워 넣는다. 데이터 프레임은 마지막 손실 이후 재동기화를 받았을
+ * 때만 성공해야 하며, 결과와 최종 상태가 순차 모델과 같아야 한다.
+ */
+static void test_resync(void) {
+  static const uint16_t ids[2] = {0x123, 0x2A0};
+  static const uint8_t tag_len[2] = {4, 2}, lambda[2] = {5, 3};
+  static uint8_t data[RESYNC_FRAMES][MINIMAC_HOST_MAX_DATA + 16];
+  static MiniMacHostFrame frames[RESYNC_FRAMES];
+  static bool expect[RESYNC_FRAMES], results[RESYNC_FRAMES];
+  static SeqNode tx[2], rx[2];
+  static MiniMacHostCtx host[2];
+  uint8_t key[16], last_resync[2][MINIMAC_HOST_RESYNC_LEN + 16] = {{0}};
+  bool synced[2] = {true, true};
+
+  for (unsigned i = 0; i < 2; i++) {
+    for (uint8_t b = 0; b < 16; b++)
+      key[b] = (uint8_t)(0x40 + ids[i] + b);
+    uint8_t hb = lambda[i] * (1 + MINIMAC_HOST_MAX_DATA);
+    seq_init(&tx[i], ids[i], key, tag_len[i], lambda[i], hb);
+    seq_init(&rx[i], ids[i], key, tag_len[i], lambda[i], hb);
+    check(minimac_host_init(&host[i], ids[i], key, 16, tag_len[i], lambda[i],
+                            0),
+          "resync: init");
+    /* 21비트 경계 직전에서 시작 */
+    tx[i].counter = rx[i].counter = host[i].counter = (1u << 21) - 7 + i;
+  }
+
+  /* (1) 프레임 만들기: 손실, 재동기화, 재동기화 위조/재전송/다른 ID */
+  unsigned n = 0;
+  while (n < RESYNC_FRAMES) {
+    unsigned i = rand() % 2, kind = rand() % 24;
+    uint8_t *d = data[n];
+    frames[n].data = d;
+    frames[n].resync = kind <= 5;
+    if (kind == 0) {
+      /* 데이터 프레임 손실 (버스에 나가지 않음) */
+      uint8_t lost[MINIMAC_HOST_MAX_DATA + 16] = {0};
+      seq_sign(&tx[i], lost, 1);
+      synced[i] = false;
+      continue;
+    }
+    if (kind <= 2) {
+      /* 정상 재동기화 (ID로 상태 고르기) */
+      frames[n].len = seq_resync_sign(&tx[i], d);
+      memcpy(last_resync[i], d, frames[n].len);
+      uint16_t to = minimac_host_resync_id(d, frames[n].len);
+      frames[n].ctx = &host[to == (ids[1] & 0x7FF)];
+      expect[n++] = synced[i] = true;
+      continue;
+    }
+    frames[n].ctx = &host[i];
+    if (kind == 3) {
+      /* 태그 비트를 뒤집은 재동기화 위조 (송신 상태는 그대로) */
+      SeqNode keep = tx[i];
+      frames[n].len = seq_resync_sign(&keep, d);
+      d[frames[n].len - 1] ^= 0x80;
+    } else if (kind == 4) {
+      /* 지난 재동기화 프레임 재전송 (첫 번째 전이면 0 페이로드) */
+      frames[n].len = (uint8_t)(MINIMAC_HOST_RESYNC_LEN + tag_len[i]);
+      memcpy(d, last_resync[i], frames[n].len);
+    } else if (kind == 5) {
+      /* 다른 ID의 상태로 넘긴 재동기화 (대상 ID 불일치) */
+      SeqNode other = tx[1 - i];
+      frames[n].len = seq_resync_sign(&other, d);
+    } else {
+      uint8_t payload_len = (uint8_t)(rand() % (MINIMAC_HOST_MAX_DATA + 1));
+      for (uint8_t b = 0; b < payload_len; b++)
+        d[b] = (uint8_t)rand();
+      frames[n].len = seq_sign(&tx[i], d, payload_len);
+      expect[n++] = synced[i];
+      continue;
+    }
+    expect[n++] = false;
+  }
+
+  /* (2) 순차 모델: 프레임을 하나씩 검증 */
+  for (unsigned k = 0; k < n; k++) {
+    unsigned i = (unsigned)(frames[k].ctx - host);
+    bool ok = frames[k].resync
+                  ? seq_resync(&rx[i], frames[k].data, frames[k].len)
+                  : seq_verify(&rx[i], frames[k].data, frames[k].len);
+    check(ok == expect[k], "resync: sequential result");
+  }
+
+  /* (3) 일괄 검증: 크기가 제각각인 묶음으로 나눠 넘김 */
+  for (unsigned k = 0; k < n;) {
+    unsigned cnt = 1 + rand() % (2 * MINIMAC_HOST_WINDOW + 10);
+    if (cnt > n - k)
+      cnt = n - k;
+    minimac_host_verify_batch(frames + k, cnt, results + k);
+    k += cnt;
+  }
+  for (unsigned k = 0; k < n; k++)
+    check(results[k] == expect[k], "resync: result");
+  for (unsigned i = 0; i < 2; i++) {
+    check(same_state(&host[i], &rx[i]), "resync: counter and history");
+    check(host[i].counter >= (1u << 21), "resync: crossed 21-bit boundary");
+  }
+}
+
+int main(void) {
+  static const char *const isas[] = {"avx512", "avx2", "sse2", "vec4",
+                                     "scalar"};
+  for (unsigned a = 0; a < sizeof(isas) / sizeof(isas[0]); a++) {
+    if (!minimac_mb_select(isas[a])) {
+      printf("skip %s (not available)\n", isas[a]);
+      continue;
+    }
+    srand(a + 1);
+    test_rfc2202();
+    test_ragged();
+    test_batch();
+    test_resync();
+  }
+  printf("%s\n", fails ? "FAILED" : "OK");
+  return fails ? 1 : 0;
+}
@@ -5,13 +5,26 @@
  * Mini-MAC은 CAN 버스 환경에서 경량화된 메시지 인증과 재생 공격 방어를 제공하는
  * HMAC 기반 프로토콜입니다. 본 헤더에는 키/태그 길이, 메시지 히스토리 정의와
  * 초기화·서명·검증 함수의 인터페이스가 포함되어 있습니다.
+ *
+ * 보호할 CAN ID마다 minimac_add()로 컨텍스트(MiniMacCtx)를 등록하고, 프레임의
+ * CAN ID로 minimac_find()를 호출해 얻은 컨텍스트로 서명/검증합니다. ID를
+ * 하나만 쓰는 스케치는 컨텍스트 없이 minimac_init()과 기존 함수를 그대로
+ * 사용할 수 있습니다.
+ *
+ * 아래 MINIMAC_* 상수는 C 함수 API가 쓰는 기본 설정입니다. 태그 길이와 λ는
+ * minimac_add()에서 ID마다 상한(MINIMAC_TAG_MAX/MINIMAC_HIST_MAX) 안으로
+ * 고를 수 있고, ID마다 다른 키 길이나 페이로드 크기가 필요하면
+ * minimac_engine.h의 MiniMac 템플릿을 직접 사용합니다.
+ * MAC 알고리즘은 기본이 HMAC-MD5이며, minimac_add()에서 컨텍스트마다
+ * Chaskey나 SipHash-2-4를 고를 수 있습니다(송수신 양쪽이 같아야 함).
  */
 #ifndef MINIMAC_H
 #define MINIMAC_H
 
 #include <Arduino.h>
 #include <EEPROM.h>
-#include <MD5.h> /**< ArduinoMD5 라이브러리 사용 */
+
+#include "minimac_log.h"
 
 //=== 설정 상수 ===
 /** @def MINIMAC_KEY_LEN
@@ -20,42 +33,310 @@
 #define MINIMAC_KEY_LEN 16
 
 /** @def MINIMAC_TAG_LEN
- *  @brief Mini-MAC 다이제스트에서 사용할 태그 길이 (4바이트, 32비트)
+ *  @brief Mini-MAC 다이제스트에서 사용할 태그 길이 (4바이트, 32비트, ≤ 8)
  */
 #define MINIMAC_TAG_LEN 4
 
+/** @def MINIMAC_TAG_MAX
+ *  @brief 컨텍스트마다 줄 수 있는 태그 길이 상한 (기본 MINIMAC_TAG_LEN)
+ *
+ * minimac_add()에서 ID마다 1..MINIMAC_TAG_MAX바이트 태그를 고를 수 있고,
+ * 고르지 않으면 MINIMAC_TAG_LEN을 씁니다. 프레임 버퍼는
+ * MINIMAC_MAX_DATA + MINIMAC_TAG_MAX바이트로 잡습니다.
+ */
+#ifndef MINIMAC_TAG_MAX
+#define MINIMAC_TAG_MAX MINIMAC_TAG_LEN
+#endif
+
 /** @def MINIMAC_HIST_LEN
- *  @brief 메시지 히스토리 최대 개수 (λ = 5)
+ *  @brief 메시지 히스토리 개수 기본값 (λ, 1..MINIMAC_HIST_MAX, 기본 5)
  */
+#ifndef MINIMAC_HIST_LEN
 #define MINIMAC_HIST_LEN 5
+#endif
+
+/** @def MINIMAC_HIST_MAX
+ *  @brief 컨텍스트마다 줄 수 있는 λ 상한 (1..254, 기본 MINIMAC_HIST_LEN)
+ *
+ * minimac_add()에서 ID마다 1..MINIMAC_HIST_MAX의 λ를 고를 수 있습니다. 모든
+ * 컨텍스트가 히스토리 버퍼와 EEPROM 히스토리 슬롯을 이 상한만큼 잡으므로,
+ * 긴 히스토리 ID가 있을 때만 늘립니다. 바꾸면 저장된 상태가 무효화됩니다.
+ */
+#ifndef MINIMAC_HIST_MAX
+#define MINIMAC_HIST_MAX MINIMAC_HIST_LEN
+#endif
 
 /** @def MINIMAC_MAX_DATA
  *  @brief CAN 데이터 필드 최대 길이 (8바이트)
  */
 #define MINIMAC_MAX_DATA 8
 
+/** @def MINIMAC_CTR_RESERVE
+ *  @brief EEPROM 저장 1회당 미리 예약하는 카운터 개수 (N, 기본 1)
+ *
+ * N > 1이면 카운터 상한(counter + N - 1)을 저장해 두고 그 구간 안에서는
+ * EEPROM을 쓰지 않습니다. 재부팅 시 카운터는 저장된 상한으로 건너뛰므로
+ * 카운터 재사용(재전송 공격 허용)은 없지만, 재부팅하지 않은 상대 노드와는
+ * 카운터가 어긋날 수 있습니다. 1이면 매 프레임 저장합니다.
+ *
+ * 예약은 서명한 컨텍스트(송신 노드)에만 적용하고, 검증만 하는 컨텍스트는
+ * 정확한 카운터를 저장합니다. 재동기화는 카운터를 앞으로만 감으므로,
+ * 재부팅한 수신 노드가 예약 상한으로 건너뛰어 송신 노드보다 앞서면 다시
+ * 맞출 수 없기 때문입니다.
+ */
+#ifndef MINIMAC_CTR_RESERVE
+#define MINIMAC_CTR_RESERVE 1
+#endif
+
+/** @def MINIMAC_HIST_BYTES
+ *  @brief 메시지 히스토리 링 버퍼 크기 (기본 λ 상한 × (1 + MINIMAC_MAX_DATA))
+ *
+ * 히스토리 항목은 길이 1바이트와 실제 페이로드만큼만 차지하도록 링 버퍼에
+ * 이어 저장됩니다. 짧은 페이로드만 쓰는 버스라면 이 값을 줄여 큰 λ를 쓸 수
+ * 있습니다 (예: λ = 32, 4바이트 페이로드 → 32 × 5 = 160). 공간이 모자라면
+ * λ개가 차기 전에도 가장 오래된 항목부터 버리므로 송수신 양측이 같은 값을
+ * 써야 합니다.
+ */
+#ifndef MINIMAC_HIST_BYTES
+#define MINIMAC_HIST_BYTES (MINIMAC_HIST_MAX * (1 + MINIMAC_MAX_DATA))
+#endif
+
+/** @def MINIMAC_LOOKAHEAD
+ *  @brief 프레임 손실 후 재동기화할 때 가정하는 최대 손실 프레임 수 (기본 0)
+ *
+ * 0이면 프레임 하나만 잃어도 양쪽을 초기화할 때까지 검증이 계속 실패합니다.
+ * k > 0이면 검증에 실패한 프레임의 페이로드를 보류해 두고, 그 꼬리가 λ개
+ * (또는 MINIMAC_HIST_BYTES)를 채운 뒤에는 손실 1..k개를 가정한 카운터로
+ * 다시 맞춰 봅니다. 일치하면 그 상태를 채택합니다. 컨텍스트마다
+ * MINIMAC_HIST_BYTES + 1 + MINIMAC_MAX_DATA바이트 RAM을 더 쓰고, 실패한
+ * 프레임마다 최대 k번의 MAC 계산이 추가됩니다.
+ */
+#ifndef MINIMAC_LOOKAHEAD
+#define MINIMAC_LOOKAHEAD 0
+#endif
+
+/** @def MINIMAC_TX_DEPTH
+ *  @brief 송신 노드가 전송 결과를 기다릴 수 있는 준비 프레임 수 (기본 4)
+ *
+ * minimac_sign_prepare()/minimac_resync_prepare()로 준비한 프레임은 송신
+ * 큐가 전송 완료나 실패를 minimac_sign_done()으로 알릴 때까지 컨텍스트에
+ * 남습니다. 이 수만큼 준비하면 다음 준비는 결과를 기다려야 하므로, 송신
+ * 큐(MINIMAC_CAN_TXQ_LEN)와 TX 버퍼 3개를 모두 채우려면 그 합으로 늘립니다.
+ * 컨텍스트마다 (1 + MINIMAC_MAX_DATA) × N바이트 RAM을 씁니다.
+ */
+#ifndef MINIMAC_TX_DEPTH
+#define MINIMAC_TX_DEPTH 4
+#endif
+
+/** @def MINIMAC_RESYNC_ID
+ *  @brief 재동기화 프레임을 보내는 CAN ID (모든 보호 대상 ID가 공유)
+ *
+ * 재동기화 프레임은 보호 대상 ID(11비트)와 카운터 하위 21비트, 태그를 실어
+ * 수신 노드의 카운터를 송신 노드에 맞추고 양쪽 히스토리를 비웁니다.
+ * 송수신 노드가 같은 값을 써야 하며 보호 대상 ID와 겹치면 안 됩니다.
+ */
+#ifndef MINIMAC_RESYNC_ID
+#define MINIMAC_RESYNC_ID 0x7F0
+#endif
+
+/** @def MINIMAC_RESYNC_PERIOD
+ *  @brief 송신 노드가 재동기화 프레임을 보내는 주기(ms, 0이면 부팅 시 1회만)
+ *
+ * 재부팅했거나 프레임을 놓쳐 어긋난 수신 노드는 늦어도 이 주기 안에 다시
+ * 맞춰집니다. 대신 재동기화 때마다 양쪽 히스토리가 비므로 그 뒤 λ개
+ * 프레임의 태그는 앞선 메시지를 덜 묶고(첫 프레임은 카운터와 페이로드만),
+ * 양쪽 모두 EEPROM에 상태를 한 번씩 기록합니다. 주기가 짧을수록 복구는
+ * 빠르지만 히스토리 보호가 약한 구간이 잦아지므로 충분히 길게 잡습니다.
+ */
+#ifndef MINIMAC_RESYNC_PERIOD
+#define MINIMAC_RESYNC_PERIOD 10000
+#endif
+
+/** @def MINIMAC_MAX_CTX
+ *  @brief 등록할 수 있는 보호 대상 CAN ID 수 (기본 1)
+ *
+ * 컨텍스트 테이블용 EEPROM(MINIMAC_EE_SIZE)은 이 개수만큼 같은 크기의
+ * 영역으로 나뉘며 minimac_add() 호출 순서대로 영역이 배정됩니다. 영역에는
+ * CAN ID가 함께 저장되어, 등록 순서가 바뀌면 해당 ID는 fresh 상태에서 다시
+ * 시작합니다. 따라서 부팅마다 같은 순서로 등록해야 합니다. 영역이 저널 슬롯
+ * 2개(약 120바이트)보다 작으면 상태를 EEPROM에 저장하지 않습니다.
+ */
+#ifndef MINIMAC_MAX_CTX
+#define MINIMAC_MAX_CTX 1
+#endif
+
+/** @def MINIMAC_EE_SIZE
+ *  @brief 컨텍스트 테이블이 쓰는 EEPROM 앞쪽 크기(Byte, 0이면 EEPROM 전체)
+ *
+ * 스케치에서 MiniMac 엔진을 따로 선언할 때는 이 값을 줄이고, 그 뒤 구간을
+ * 엔진의 begin()에 넘깁니다.
+ */
+#ifndef MINIMAC_EE_SIZE
+#define MINIMAC_EE_SIZE 0
+#endif
+
+/** @def MINIMAC_MD5_UNROLL
+ *  @brief MD5 압축 함수 64단계 전개 여부 (기본 1)
+ *
+ * 1이면 상수와 회전량이 명령어에 들어간 전개 코드로 HMAC-MD5가 가장 빠르고,
+ * 0이면 PROGMEM 상수 표를 읽는 루프로 플래시를 아낍니다.
+ */
+#ifndef MINIMAC_MD5_UNROLL
+#define MINIMAC_MD5_UNROLL 1
+#endif
+
+/** @def MINIMAC_SELFTEST
+ *  @brief MAC 자체 시험(minimac_selftest()) 포함 여부 (기본 0)
+ *
+ * 1이면 알려진 답 시험(KAT)과 ArduinoMD5 라이브러리와의 비교, 블록당 사이클
+ * 측정을 포함합니다. 이때만 ArduinoMD5 라이브러리가 필요합니다.
+ */
+#ifndef MINIMAC_SELFTEST
+#define MINIMAC_SELFTEST 0
+#endif
+
+/** @def MINIMAC_SIG_MAGIC
+ *  @brief EEPROM 상태 시그니처의 상위 바이트 (레이아웃 식별용)
+ */
+#ifndef MINIMAC_SIG_MAGIC
+#define MINIMAC_SIG_MAGIC 0xA5
+#endif
+
 /**
- * @struct MiniMacHist
- * @brief 과거 페이로드를 저장하기 위한 구조체
+ * @brief 컨텍스트별 MAC 알고리즘 (minimac_add()에서 선택)
+ */
+typedef enum {
+  MINIMAC_MAC_HMAC_MD5 = 0, ///< HMAC-MD5 (기본, 기존 노드와 태그 호환)
+  MINIMAC_MAC_CHASKEY,      ///< Chaskey-12 (16바이트 키, 32비트 연산만 사용)
+  MINIMAC_MAC_SIPHASH       ///< SipHash-2-4 (16바이트 키, 64비트 출력)
+} MiniMacAlg;
+
+/**
+ * @brief 보호 대상 CAN ID 하나의 Mini-MAC 상태 (카운터, 히스토리, 키 상태)
+ *
+ * 내부 구조는 minimac.cpp에만 공개되며, 호출자는 minimac_add()/
+ * minimac_find()가 돌려준 포인터로만 다룹니다.
+ */
+typedef struct MiniMacCtx MiniMacCtx;
+
+/**
+ * @brief 일괄 검증할 수신 프레임 하나 (minimac_verify_batch())
+ */
+typedef struct {
+  uint16_t can_id;     ///< 수신 CAN ID (표준 11비트)
+  uint8_t len;         ///< 수신 길이 (페이로드 + 태그, DLC)
+  const uint8_t *data; ///< 수신 데이터 (페이로드 ‖ 태그)
+} MiniMacFrame;
+
+/**
+ * @brief 일괄 서명할 송신 프레임 하나 (minimac_sign_batch())
+ *
+ * data는 MINIMAC_MAX_DATA + MINIMAC_TAG_MAX바이트 이상이어야 합니다.
+ */
+typedef struct {
+  uint16_t can_id; ///< 송신 CAN ID
+  uint8_t len;     ///< 입력: 페이로드 길이, 출력: 전송 길이 (실패 시 0)
+  uint8_t *data;   ///< 페이로드 버퍼 (서명 후 뒤에 태그가 붙음)
+} MiniMacTxFrame;
+
+/**
+ * @brief MCP2515 수신 마스크/필터 설정 (표준 11비트 ID, minimac_can_filter())
  *
- * @var MiniMacHist::len   저장된 페이로드 길이
- * @var MiniMacHist::data  페이로드 데이터(최대 8바이트)
+ * RXB0는 mask[0]과 filt[0..1], RXB1은 mask[1]과 filt[2..5]를 씁니다. ID x는
+ * 어느 버퍼의 필터 F에 대해 (x & M) == (F & M)이면 수신됩니다(M은 그 버퍼의
+ * 마스크).
  */
 typedef struct {
-  uint8_t len;                    /**< 페이로드 길이 (바이트) */
-  uint8_t data[MINIMAC_MAX_DATA]; /**< 페이로드 데이터 버퍼 */
-} MiniMacHist;
+  uint16_t mask[2]; ///< RXM0, RXM1
+  uint16_t filt[6]; ///< RXF0..RXF5
+} MiniMacCanFilter;
+
+/**
+ * @brief 보호할 CAN ID 등록 및 EEPROM 상태 동기화
+ * @param can_id 보호할 CAN 메시지 식별자 (16비트)
+ * @param key    이 ID의 그룹 키 (128비트, 16바이트)
+ * @return 등록된 컨텍스트, MINIMAC_MAX_CTX개가 이미 등록됐으면 NULL
+ *
+ * HMAC-MD5, λ = MINIMAC_HIST_LEN, 태그 MINIMAC_TAG_LEN바이트로 등록합니다.
+ * EEPROM 영역에서 이 ID의 이전 상태를 불러오고, 유효하지 않으면 카운터와
+ * 히스토리를 초기화하여 fresh 상태로 설정합니다. 이미 등록된 ID를 다시
+ * 넘기면 새로 등록하지 않고 그 컨텍스트를 EEPROM 상태로 재초기화합니다.
+ */
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key);
+
+/**
+ * @brief 보호할 CAN ID를 지정한 MAC 알고리즘으로 등록
+ * @param can_id 보호할 CAN 메시지 식별자 (16비트)
+ * @param key    이 ID의 그룹 키 (128비트, 16바이트)
+ * @param mac    MAC 알고리즘 (송신/수신 노드가 같아야 함)
+ * @return 등록된 컨텍스트, 테이블이 가득 찼거나 키 길이가 알고리즘에 맞지
+ *         않으면 NULL
+ *
+ * 고주기 ID처럼 양쪽 노드를 함께 바꿀 수 있으면 MINIMAC_MAC_CHASKEY나
+ * MINIMAC_MAC_SIPHASH가 HMAC-MD5보다 몇 배 빠릅니다. 이미 등록된 ID를 다시
+ * 넘기면 알고리즘을 바꾸고 EEPROM 상태로 재초기화합니다. λ와 태그 길이는
+ * MINIMAC_HIST_LEN/MINIMAC_TAG_LEN입니다.
+ */
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key, MiniMacAlg mac);
+
+/**
+ * @brief 보호할 CAN ID를 MAC 알고리즘, λ, 태그 길이를 지정해 등록
+ * @param can_id  보호할 CAN 메시지 식별자 (16비트)
+ * @param key     이 ID의 그룹 키 (128비트, 16바이트)
+ * @param mac     MAC 알고리즘 (송신/수신 노드가 같아야 함)
+ * @param lambda  메시지 히스토리 길이 λ (1..MINIMAC_HIST_MAX)
+ * @param tag_len 태그 길이(Byte, 1..MINIMAC_TAG_MAX)
+ * @return 등록된 컨텍스트, 테이블이 가득 찼거나 키 길이, λ, 태그 길이가
+ *         맞지 않으면 NULL
+ *
+ * 고주기 ID는 짧은 태그로 페이로드 자리를 늘리고, 드문 ID는 긴 히스토리로
+ * 더 많은 앞선 메시지를 묶는 식으로 한 컨텍스트 테이블에 섞어 쓸 수
+ * 있습니다. 송신/수신 노드가 ID마다 같은 값을 써야 합니다.
+ */
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key, MiniMacAlg mac,
+                        uint8_t lambda, uint8_t tag_len);
+
+/**
+ * @brief CAN ID로 등록된 컨텍스트 찾기 (해시 인덱스, 평균 O(1))
+ * @param can_id 프레임의 CAN ID
+ * @return 등록된 컨텍스트, 보호 대상 ID가 아니면 NULL
+ */
+MiniMacCtx *minimac_find(uint16_t can_id);
+
+/**
+ * @brief 등록 순서 번호로 컨텍스트 찾기 (O(1))
+ * @param index minimac_add() 호출 순서 (0부터)
+ * @return 컨텍스트, 아직 등록되지 않은 번호면 NULL
+ */
+MiniMacCtx *minimac_ctx_at(uint16_t index);
 
 /**
  * @brief Mini-MAC 프로토콜 초기화
  * @param can_id 보호할 CAN 메시지 식별자 (16비트)
  * @param key    그룹 키 (128비트, 16바이트)
  *
- * EEPROM에서 이전 상태를 불러오고, 유효하지 않으면 내부 카운터와
- * 히스토리를 초기화하여 fresh 상태로 설정합니다.
+ * minimac_add()로 ID를 등록하고 그 컨텍스트를 기본 컨텍스트로 지정합니다.
+ * 컨텍스트 인자가 없는 minimac_reset()/minimac_sign()/minimac_verify()는
+ * 기본 컨텍스트를 사용합니다.
  */
 void minimac_init(uint16_t can_id, const uint8_t *key);
 
+/**
+ * @brief 저장된 상태를 무효화하고 fresh 상태로 시작
+ *
+ * minimac_init() 이후에 호출합니다. 카운터와 히스토리를 0으로 되돌리고
+ * 이를 EEPROM 저널의 새 레코드로 기록하므로, 이전 상태는 EEPROM 전체를
+ * 지우지 않아도 다시 읽히지 않습니다. 기록은 쓰기 큐로 진행되어 부팅 시간을
+ * 거의 늘리지 않습니다.
+ */
+void minimac_reset(void);
+
+/**
+ * @brief 컨텍스트 하나의 저장된 상태를 무효화하고 fresh 상태로 시작
+ * @param ctx 대상 컨텍스트
+ */
+void minimac_reset(MiniMacCtx *ctx);
+
 /**
  * @brief 송신 전 페이로드에 Mini-MAC 태그 생성 및 붙이기
  * @param data         서명할 페이로드 버퍼
@@ -64,10 +345,119 @@ void minimac_init(uint16_t can_id, const uint8_t *key);
  *
  * data[0..payload_len-1] 구간을 포함해 HMAC-MD5를 수행하고,
  * 상위 4바이트를 태그로 data[payload_len..]에 덧붙입니다.
- * 내부 카운터와 히스토리를 갱신한 후 EEPROM에 저장합니다.
+ * 내부 카운터와 히스토리를 갱신한 후, 카운터 예약 구간
+ * (MINIMAC_CTR_RESERVE)을 벗어났으면 EEPROM 쓰기 큐에 저장을 요청합니다.
+ * EEPROM 기록은 인터럽트로 진행되므로 태그 계산이 끝나면 바로 반환합니다.
+ * minimac_sign_prepare()로 준비한 프레임의 결과를 기다리는 동안에는 순서가
+ * 어긋나므로 서명하지 않고 0을 돌려줍니다.
  */
 uint8_t minimac_sign(uint8_t *data, uint8_t payload_len);
 
+/**
+ * @brief 지정한 컨텍스트(송신 CAN ID)로 태그 생성 및 붙이기
+ * @param ctx          송신 CAN ID의 컨텍스트
+ * @param data         서명할 페이로드 버퍼
+ * @param payload_len  페이로드 길이(바이트)
+ * @return 전체 데이터 길이 (payload_len + 컨텍스트의 태그 길이)
+ */
+uint8_t minimac_sign(MiniMacCtx *ctx, uint8_t *data, uint8_t payload_len);
+
+/**
+ * @brief 2단계 서명 준비: 태그만 붙이고 카운터·히스토리는 그대로 둠
+ * @param ctx          송신 CAN ID의 컨텍스트
+ * @param data         서명할 페이로드 버퍼
+ * @param payload_len  페이로드 길이(바이트)
+ * @return 전체 데이터 길이 (payload_len + 컨텍스트의 태그 길이), 결과를
+ *         기다리는 준비 프레임이 이미 MINIMAC_TX_DEPTH개면 0
+ *
+ * minimac_sign()은 전송 전에 상태를 넘기므로 전송이 실패하면 송신 측만
+ * 앞서 나가 이후 프레임이 모두 검증에 실패합니다. 대신 이 함수로 태그를
+ * 붙여 보내고, 전송 결과를 준비 순서대로 minimac_sign_done()(송신 큐의
+ * 완료 알림) 또는 minimac_sign_commit()으로 알립니다. 송신 큐에 넣지
+ * 못했으면 바로 minimac_sign_abort()로 버립니다.
+ * 결과를 기다리는 프레임이 있으면 다음 프레임은 그 프레임들이 모두 나간
+ * 상태를 가정해 서명하므로, 송신 큐에 여러 프레임을 넣어 둘 수 있습니다.
+ */
+uint8_t minimac_sign_prepare(MiniMacCtx *ctx, uint8_t *data,
+                             uint8_t payload_len);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 준비
+ */
+uint8_t minimac_sign_prepare(uint8_t *data, uint8_t payload_len);
+
+/**
+ * @brief 2단계 서명 확정: 가장 먼저 준비한 프레임의 전송 성공 후 카운터·
+ *        히스토리 갱신 및 저장
+ * @param ctx          송신 CAN ID의 컨텍스트
+ * @param data         minimac_sign_prepare()에 넘긴 페이로드 (같은 내용)
+ * @param payload_len  페이로드 길이(바이트)
+ * @return true  상태 갱신
+ * @return false 가장 오래된 준비 프레임이 이 페이로드가 아님
+ */
+bool minimac_sign_commit(MiniMacCtx *ctx, const uint8_t *data,
+                         uint8_t payload_len);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 확정
+ */
+bool minimac_sign_commit(const uint8_t *data, uint8_t payload_len);
+
+/**
+ * @brief 2단계 서명 취소: 마지막으로 준비한 프레임을 버림 (송신 큐에 넣지
+ *        못했을 때)
+ * @param ctx 송신 CAN ID의 컨텍스트
+ *
+ * 이미 큐에 넣은 프레임의 실패는 minimac_sign_done()으로 알립니다. 버스에
+ * 나갔는지 모르는 프레임을 버렸으면 수신 노드와 어긋날 수 있으므로
+ * 재동기화 프레임을 보냅니다.
+ */
+void minimac_sign_abort(MiniMacCtx *ctx);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 취소
+ */
+void minimac_sign_abort(void);
+
+/**
+ * @brief 가장 먼저 준비한 프레임의 전송 결과 알림 (ISR에서 호출 가능)
+ * @param ctx  프레임을 준비한 컨텍스트
+ * @param sent true 버스에 나감, false 버려짐
+ *
+ * 송신 큐(MiniMacCanTx)의 완료 알림 함수에서 준비 순서대로 호출합니다.
+ * 결과만 기록하고, 카운터·히스토리 갱신과 EEPROM 저장은 다음
+ * minimac_sign_prepare()/minimac_resync_prepare() 또는
+ * minimac_sign_pending()에서 메인 루프가 합니다. 버린 프레임 뒤에 준비한
+ * 프레임은 그 페이로드를 히스토리에 넣어 서명했으므로 함께 버려야 합니다.
+ */
+void minimac_sign_done(MiniMacCtx *ctx, bool sent);
+
+/**
+ * @brief 알린 전송 결과를 반영한 뒤 아직 결과를 모르는 준비 프레임 수
+ * @param ctx 송신 CAN ID의 컨텍스트
+ * @return 준비 프레임 수 (MINIMAC_TX_DEPTH이면 다음 준비는 실패)
+ */
+uint8_t minimac_sign_pending(MiniMacCtx *ctx);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())의 결과를 모르는 준비 프레임 수
+ */
+uint8_t minimac_sign_pending(void);
+
+/**
+ * @brief 송신할 페이로드 여러 개를 순서대로 서명하고 상태는 한 번만 저장
+ * @param frames 송신 순서대로 놓인 프레임 배열 (len이 전송 길이로 바뀜)
+ * @param n      프레임 수
+ * @return 서명한 프레임 수
+ *
+ * 같은 CAN ID의 프레임은 배열 순서대로 카운터와 히스토리를 이어 서명하므로
+ * 이 순서대로 송신해야 합니다. 등록되지 않은 ID나 MINIMAC_MAX_DATA보다 긴
+ * 페이로드는 서명하지 않고 len을 0으로 만듭니다. EEPROM 저장은 끝에서 바뀐
+ * 컨텍스트마다 한 번씩 요청하므로, 한 주기에 여러 신호를 보낼 때 서명
+ * 속도가 EEPROM 쓰기가 아니라 MAC 계산으로 정해집니다.
+ */
+uint8_t minimac_sign_batch(MiniMacTxFrame *frames, uint8_t n);
+
 /**
  * @brief 수신 후 Mini-MAC 태그 검증 및 내부 상태 갱신
  * @param data         검증할 페이로드 버퍼
@@ -83,4 +473,132 @@ uint8_t minimac_sign(uint8_t *data, uint8_t payload_len);
 bool minimac_verify(const uint8_t *data, uint8_t payload_len,
                     const uint8_t *tag);
 
+/**
+ * @brief 지정한 컨텍스트(수신 CAN ID)로 태그 검증 및 상태 갱신
+ * @param ctx          수신 CAN ID의 컨텍스트 (minimac_find())
+ * @param data         검증할 페이로드 버퍼
+ * @param payload_len  페이로드 길이(바이트)
+ * @param tag          수신된 태그 버퍼 (컨텍스트의 태그 길이)
+ * @return true  검증 성공 (내부 상태 갱신 및 EEPROM 저장)
+ * @return false 검증 실패 (TAG 불일치)
+ */
+bool minimac_verify(MiniMacCtx *ctx, const uint8_t *data, uint8_t payload_len,
+                    const uint8_t *tag);
+
+/**
+ * @brief 수신한 CAN 프레임을 그대로 넘겨 태그 검증 및 상태 갱신
+ * @param can_id 드라이버가 돌려준 CAN ID (확장 ID면 bit 31, 원격 프레임이면
+ *               bit 30)
+ * @param len    수신 길이(DLC, 페이로드 + 태그)
+ * @param data   수신 데이터 (페이로드 ‖ 태그)
+ * @return true  검증 성공 (내부 상태 갱신 및 EEPROM 저장)
+ * @return false 등록되지 않은 ID, 확장 ID나 원격 프레임, 태그보다 짧거나
+ *               페이로드가 MINIMAC_MAX_DATA를 넘는 프레임, 또는 태그 불일치
+ *
+ * CAN ID로 컨텍스트를 찾고 data를 그 컨텍스트의 태그 길이로 페이로드와
+ * 태그로 제자리에서 나눠 검증합니다. 페이로드를 따로 복사하지 않으므로
+ * MiniMacCan::read()가 채운 버퍼를 바로 넘깁니다. 성공하면 페이로드만
+ * 히스토리에 기록됩니다.
+ */
+bool minimac_verify_frame(uint32_t can_id, uint8_t len, const uint8_t *data);
+
+/**
+ * @brief 재동기화 프레임 준비 (송신 노드, 상태 변경 없음)
+ * @param ctx 알릴 CAN ID의 컨텍스트
+ * @param buf 프레임 버퍼 (4 + MINIMAC_TAG_MAX바이트 이상)
+ * @return 전송 길이 (4 + 컨텍스트의 태그 길이), 결과를 기다리는 준비
+ *         프레임이 이미 MINIMAC_TX_DEPTH개면 0
+ *
+ * 준비 프레임이 모두 나간 뒤의 카운터를 알리는 인증된 프레임을 만듭니다.
+ * MINIMAC_RESYNC_ID로 보낸 뒤 결과를 minimac_sign_done() 또는
+ * minimac_resync_commit()으로 알리고, 넣지 못했으면 minimac_sign_abort()로
+ * 버립니다.
+ */
+uint8_t minimac_resync_prepare(MiniMacCtx *ctx, uint8_t *buf);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 재동기화 프레임 준비
+ */
+uint8_t minimac_resync_prepare(uint8_t *buf);
+
+/**
+ * @brief 재동기화 프레임 전송 성공 후 상태 확정 (카운터 + 1, 히스토리 비움)
+ * @param ctx 알린 CAN ID의 컨텍스트
+ * @return true  상태 갱신, false 가장 오래된 준비 프레임이 재동기화 프레임이
+ *         아님
+ */
+bool minimac_resync_commit(MiniMacCtx *ctx);
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 재동기화 프레임 확정
+ */
+bool minimac_resync_commit(void);
+
+/**
+ * @brief 수신한 재동기화 프레임(MINIMAC_RESYNC_ID)을 검증하고 상태 맞추기
+ * @param data 수신 데이터
+ * @param len  수신 길이(DLC)
+ * @return true  검증 성공, 해당 ID의 카운터를 송신 노드에 맞추고 히스토리를
+ *               비움
+ * @return false 보호 대상이 아닌 ID, 길이 오류 또는 태그 불일치
+ *
+ * 프레임이 가리키는 ID의 컨텍스트를 찾아 검증합니다. 카운터는 앞으로만
+ * 감기므로 예전 재동기화 프레임을 재전송해도 받아들이지 않습니다.
+ */
+bool minimac_resync(const uint8_t *data, uint8_t len);
+
+/**
+ * @brief 수신 프레임 여러 개를 순서대로 검증하고 상태는 한 번만 저장
+ * @param frames  수신 순서대로 놓인 프레임 배열
+ * @param n       프레임 수
+ * @param results 프레임별 결과 저장 위치 (NULL이면 기록하지 않음)
+ * @return 검증에 성공한 프레임 수
+ *
+ * 각 프레임을 CAN ID의 컨텍스트로 검증하며, 같은 ID의 프레임은 앞 프레임이
+ * 갱신한 카운터와 히스토리로 이어서 검증합니다. 등록되지 않은 ID, 태그보다
+ * 짧거나 페이로드가 MINIMAC_MAX_DATA를 넘는 프레임은 실패입니다. EEPROM
+ * 저장은 프레임마다 하지 않고 끝에서 바뀐 컨텍스트마다 한 번씩 요청하므로,
+ * RX 버퍼가 찼을 때나 로그를 재생할 때 밀린 프레임을 빨리 처리합니다.
+ */
+uint8_t minimac_verify_batch(const MiniMacFrame *frames, uint8_t n,
+                             bool *results);
+
+/**
+ * @brief 등록된 CAN ID와 MINIMAC_RESYNC_ID만 받는 MCP2515 마스크/필터 계산
+ * @param f 결과 저장 위치
+ * @return 이 설정으로 수신되는 표준 ID 수 (보호 대상이 아닌 ID 포함)
+ *
+ * 수신할 ID가 6개 이하이면 ID마다 필터 하나로 정확히 거릅니다. 그보다 많으면
+ * 수신되는 ID 수가 가장 적게 늘도록 ID를 묶어 필터 6개와 마스크 2개에
+ * 나눕니다. 마스크에 걸리지 않는 ID도 일부 수신되므로 소프트웨어 분류는
+ * 그대로 필요합니다. minimac_add()로 모든 ID를 등록한 뒤 호출합니다.
+ *
+ * 수신 ID 수가 같으면 RXB0에 ID를 우선 배정합니다. 등록 ID가 하나이거나
+ * 묶음이 2개 이하이면 재동기화 ID를 포함한 모든 ID가 RXB0 필터에 걸려 RXB1은
+ * rollover로만 채워지므로, MiniMacCan::read()가 재동기화 프레임과 데이터
+ * 프레임을 버스 순서대로 돌려줍니다.
+ */
+uint16_t minimac_can_filter(MiniMacCanFilter *f);
+
+#if MINIMAC_SELFTEST
+/**
+ * @brief MAC 구현 자체 시험 (MINIMAC_SELFTEST 빌드 전용)
+ * @return true 모든 알려진 답 시험 통과
+ *
+ * RFC 1321 MD5, RFC 2202 HMAC-MD5, SipHash-2-4, Chaskey-12 기준 벡터를
+ * 확인하고, HMAC-MD5 백엔드 결과가 ArduinoMD5의 MD5::hmac_md5()와 같은지
+ * 비교합니다.
+ * 자체 MD5와 라이브러리 MD5의 블록당 사이클 수를 INFO 로그로 출력합니다.
+ */
+bool minimac_selftest(void);
+#endif
+
+/**
+ * @brief 대기 중인 EEPROM 상태 저장이 모두 기록될 때까지 대기 (배리어)
+ *
+ * minimac_sign()/minimac_verify()는 EEPROM 기록 완료를 기다리지 않습니다.
+ * 전원 차단·리셋 등 종료 경로나 EEPROM을 직접 다루기 전에 호출합니다.
+ */
+void minimac_flush(void);
+
 #endif // MINIMAC_H
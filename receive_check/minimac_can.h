@@ -0,0 +1,285 @@
+/**
+ * @file minimac_can.h
+ * @brief MCP2515 CAN 컨트롤러 경량 드라이버 (버스트 SPI 명령 사용)
+ *
+ * 범용 mcp_can 라이브러리는 프레임 하나를 읽을 때 상태, ID, DLC, 데이터를
+ * 각각 레지스터 읽기로 가져오고 플래그를 따로 지우므로 SPI 트랜잭션이 여러
+ * 번 필요합니다. 이 드라이버는 MCP2515 전용 명령으로 프레임을 통째로
+ * 옮깁니다.
+ *
+ * - 수신: RX STATUS(2바이트)로 프레임이 있는 버퍼를 고르고, READ RX
+ *   BUFFER 한 번으로 ID·DLC·데이터를 읽습니다. CS를 올리면 칩이 RXnIF를
+ *   스스로 지우므로 플래그 해제 명령이 없습니다. 8바이트 프레임 하나에
+ *   SPI 16바이트, CS 구간 2번입니다.
+ * - 송신: LOAD TX BUFFER 한 번으로 ID·DLC·데이터를 쓰고 RTS로 전송을
+ *   요청합니다.
+ * - 송신 큐(MiniMacCanTx): 프레임을 SRAM 큐에 넣고 TX 버퍼 3개를 모두
+ *   채웁니다. 전송 완료 인터럽트에서 빈 버퍼를 다시 채우므로 다음
+ *   프레임에 서명하는 동안에도 버스가 쉬지 않습니다.
+ *
+ * SPI 클럭은 MCP2515 최대값인 10MHz로 요청합니다(16MHz AVR은 8MHz).
+ * 표준 11비트 ID만 송신하며, 수신한 확장 ID 프레임은 mcp_can과 같이 ID의
+ * bit 31을 켜서 돌려줍니다.
+ *
+ * 호스트에서 MINIMAC_CAN_MOCK을 정의하고 컴파일하면 SPI 대신 host/의
+ * MCP2515 모델(minimac_can_mock.h)에 연결됩니다.
+ */
+#ifndef MINIMAC_CAN_H
+#define MINIMAC_CAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @def MINIMAC_CAN_TXQ_LEN
+ *  @brief MiniMacCanTx 송신 큐 길이 (프레임 수, 2의 거듭제곱, 128 이하)
+ *
+ * TX 버퍼 3개와 별도이며 항목 하나에 11바이트(AVR)를 씁니다.
+ */
+#ifndef MINIMAC_CAN_TXQ_LEN
+#define MINIMAC_CAN_TXQ_LEN 4
+#endif
+
+/**
+ * @brief MCP2515 하나를 다루는 드라이버 (CS 핀 하나)
+ *
+ * begin()으로 설정 모드에서 초기화하고, 필요하면 set_filter()로 마스크와
+ * 필터를 쓴 뒤 set_mode(MODE_NORMAL)로 버스에 참여합니다. 수신 인터럽트
+ * (RX0IE, RX1IE)가 켜지므로 INT 핀은 수신 버퍼에 프레임이 있는 동안
+ * LOW입니다.
+ */
+class MiniMacCan {
+public:
+  /// 동작 모드 (CANCTRL.REQOP)
+  static constexpr uint8_t MODE_NORMAL = 0x00;   ///< 정상 동작
+  static constexpr uint8_t MODE_LOOPBACK = 0x40; ///< 내부 루프백
+  static constexpr uint8_t MODE_LISTEN = 0x60;   ///< 수신 전용
+  static constexpr uint8_t MODE_CONFIG = 0x80;   ///< 설정 (마스크/필터 변경)
+
+  /// send()가 전송 완료를 기다리는 최대 시간(µs)
+  static constexpr uint32_t TX_TIMEOUT_US = 10000;
+
+  /**
+   * @brief 드라이버 생성 (하드웨어는 begin()에서 초기화)
+   * @param cs MCP2515 칩 선택(CS) 핀
+   */
+  explicit MiniMacCan(uint8_t cs) : cs(cs), rxb1_old(false) {}
+
+  /**
+   * @brief 컨트롤러 리셋 및 비트 타이밍, 수신 버퍼, 인터럽트 설정
+   * @param kbps    CAN 비트 속도 (125, 250, 500, 1000)
+   * @param osc_mhz MCP2515 발진자 주파수 (8, 16)
+   * @return true  설정 모드에서 초기화 완료
+   * @return false 칩 응답 없음 또는 지원하지 않는 속도/클럭 조합
+   *
+   * 두 수신 버퍼 모두 마스크/필터를 쓰며(리셋 직후 마스크가 0이라 모든
+   * 프레임 통과), RXB0가 차 있으면 RXB1로 넘깁니다(rollover).
+   */
+  bool begin(uint16_t kbps, uint8_t osc_mhz);
+
+  /**
+   * @brief 동작 모드 변경 후 전환 확인
+   * @param mode MODE_NORMAL, MODE_LOOPBACK, MODE_LISTEN, MODE_CONFIG
+   * @return true 전환됨, false 칩이 모드를 바꾸지 않음
+   */
+  bool set_mode(uint8_t mode);
+
+  /**
+   * @brief 표준 ID 수신 마스크/필터 설정 (설정 모드에서만 유효)
+   * @param mask RXM0, RXM1 (11비트)
+   * @param filt RXF0..RXF5 (11비트, RXF0..1은 RXB0, RXF2..5는 RXB1)
+   *
+   * 필터는 표준 ID 프레임만 통과시키고 데이터 바이트는 비교하지 않습니다.
+   * minimac_can_filter()의 결과를 그대로 넘깁니다.
+   */
+  void set_filter(const uint16_t *mask, const uint16_t *filt);
+
+  /**
+   * @brief 수신 버퍼의 프레임 하나 읽기 (ISR에서 호출 가능)
+   * @param id   CAN ID (확장 ID면 bit 31, 원격 프레임이면 bit 30이 켜짐)
+   * @param len  데이터 길이 (0..8)
+   * @param data 데이터 (8바이트 이상)
+   * @return true 프레임 읽음, false 수신 버퍼가 비어 있음
+   *
+   * 두 버퍼 모두 차 있으면 먼저 도착한 쪽부터 읽습니다. rollover로 RXB1이
+   * 채워졌으면 RXB0가 먼저이고, RXB1이 남은 채로 RXB0를 읽은 뒤 RXB0에 새
+   * 프레임이 들어왔으면 RXB1이 먼저입니다. 따라서 RXB0 필터에 걸리는 ID는
+   * 도착 순서대로 나옵니다(RXB1 필터에만 걸리는 ID는 RXB1 하나로만 받음).
+   */
+  bool read(uint32_t *id, uint8_t *len, uint8_t *data);
+
+  /**
+   * @brief 표준 ID 프레임 하나 전송 후 완료 대기
+   * @param id   표준 CAN ID (11비트)
+   * @param len  데이터 길이 (0..8)
+   * @param data 데이터
+   * @return true  버스에 전송됨
+   * @return false TX_TIMEOUT_US 안에 전송되지 않아 요청을 취소함
+   *
+   * TXB0를 씁니다. 시간 초과로 취소하는 사이에 전송이 끝났으면 true입니다.
+   * 같은 컨트롤러에서 MiniMacCanTx와 섞어 쓰지 않습니다.
+   */
+  bool send(uint16_t id, uint8_t len, const uint8_t *data);
+
+  /**
+   * @brief INT 핀을 LOW로 만들 인터럽트 원인 선택 (CANINTE)
+   * @param rx 수신 버퍼 채워짐 (RX0IE, RX1IE, begin()의 기본값)
+   * @param tx 전송 완료 (TX0IE, TX1IE, TX2IE)
+   */
+  void set_irq(bool rx, bool tx);
+
+  /**
+   * @brief TX 버퍼 하나에 프레임을 쓰고 전송 요청 (MiniMacCanTx용)
+   * @param n    TX 버퍼 번호 (0..2, 전송 대기 중이 아니어야 함)
+   * @param prio 전송 우선순위 TXP (0..3, 높을수록 먼저)
+   * @param id   표준 CAN ID (11비트)
+   * @param len  데이터 길이 (0..8)
+   * @param data 데이터
+   *
+   * WRITE 한 번으로 TXBnCTRL(우선순위)부터 데이터까지 쓰고 RTS를 보냅니다.
+   */
+  void tx_load(uint8_t n, uint8_t prio, uint16_t id, uint8_t len,
+               const uint8_t *data);
+
+  /**
+   * @brief 전송을 마친 TX 버퍼 확인 후 완료 플래그 해제 (MiniMacCanTx용)
+   * @return 전송을 마친 버퍼 (bit n = TXBn), 없으면 0
+   */
+  uint8_t tx_done(void);
+
+  /**
+   * @brief 대기 중인 모든 TX 버퍼의 전송 요청 취소 (ABAT)
+   *
+   * 이미 버스에 나가고 있는 프레임은 끝까지 전송되므로 취소가 끝날 때까지
+   * 기다립니다. 끝까지 전송된 버퍼는 tx_done()에 나타납니다.
+   */
+  void tx_abort(void);
+
+private:
+  uint8_t cs;    ///< 칩 선택 핀
+  bool rxb1_old; ///< RXB1의 프레임이 RXB0에 새로 들어올 프레임보다 먼저 옴
+
+  void select(void);
+  void deselect(void);
+  uint8_t read_reg(uint8_t addr);
+  void write_regs(uint8_t addr, const uint8_t *val, uint8_t n);
+  void modify_reg(uint8_t addr, uint8_t mask, uint8_t val);
+  uint8_t status(void);
+};
+
+/**
+ * @brief 송신 큐 프레임의 전송 결과 알림 함수
+ * @param tag  push()에 넘긴 태그 (NULL이면 불리지 않음)
+ * @param sent true 버스에 나감, false 버스에 나가지 못하고 버려짐
+ *
+ * service()(INT 핀 ISR)와 abort()(인터럽트를 막은 상태)에서 push() 순서대로
+ * 불리므로 짧게 끝내야 합니다.
+ */
+typedef void (*MiniMacCanTxDone)(void *tag, bool sent);
+
+/**
+ * @brief MCP2515 TX 버퍼 3개를 모두 쓰는 송신 큐
+ *
+ * push()는 프레임을 SRAM 큐에 넣고 빈 TX 버퍼가 있으면 바로 옮긴 뒤
+ * 반환합니다. 전송 완료 인터럽트에서 service()가 끝난 버퍼를 큐의 다음
+ * 프레임으로 채우므로, 호출자는 그동안 다음 프레임에 서명할 수 있습니다.
+ *
+ * Mini-MAC 수신 노드는 같은 ID의 프레임을 보낸 순서대로 받아야 합니다.
+ * MCP2515는 대기 중인 버퍼 가운데 우선순위(TXP)가 높은 것, 같으면 번호가
+ * 큰 것부터 보내므로 새로 채우는 버퍼에는 대기 중인 버퍼보다 낮은
+ * 우선순위를 줍니다. 우선순위가 0까지 내려가면 대기 중인 버퍼가 모두 빌
+ * 때까지 채우지 않으므로, 4프레임마다 버퍼를 다시 채우는 시간만큼 버스가
+ * 쉽니다.
+ *
+ * 완료 알림 함수를 주면 프레임마다 전송 결과를 push() 순서대로 알립니다.
+ * 버퍼는 채운 순서대로 비므로 service()는 끝난 버퍼 수만큼 가장 먼저 채운
+ * 프레임부터 완료로 알리고, abort()는 그 전에 끝난 프레임을 완료로 알린
+ * 뒤 남은 버퍼와 큐의 프레임을 순서대로 실패로 알립니다. Mini-MAC 송신
+ * 노드는 이 알림으로 준비한 서명을 확정하거나 되돌립니다
+ * (minimac_sign_done()).
+ *
+ * 컨트롤러의 INT 핀 인터럽트에서 service()를 호출하고, 나머지 함수는
+ * 인터럽트 밖에서만 호출합니다.
+ */
+class MiniMacCanTx {
+public:
+  /**
+   * @brief 송신 큐 생성
+   * @param can  프레임을 보낼 컨트롤러
+   * @param done 프레임별 전송 결과 알림 함수 (NULL이면 알리지 않음)
+   */
+  explicit MiniMacCanTx(MiniMacCan &can, MiniMacCanTxDone done = NULL)
+      : can(can), done(done), head(0), tail(0), busy(0), prio(0), fly_head(0),
+        fly_tail(0) {}
+
+  /**
+   * @brief 큐를 비우고 INT 핀을 전송 완료 인터럽트로 전환
+   *
+   * can.begin() 이후에 호출합니다. 수신 인터럽트는 끕니다(송신 전용 노드).
+   */
+  void begin(void);
+
+  /**
+   * @brief 프레임 하나를 전송 순서의 끝에 추가
+   * @param id   표준 CAN ID (11비트)
+   * @param len  데이터 길이 (0..8)
+   * @param data 데이터 (큐에 복사됨)
+   * @param tag  전송 결과 알림 함수에 넘길 값 (NULL이면 알리지 않음)
+   * @return true 추가됨, false 큐가 가득 참
+   */
+  bool push(uint16_t id, uint8_t len, const uint8_t *data, void *tag = NULL);
+
+  /**
+   * @brief 큐에 빈 자리가 있는지 (true면 다음 push()가 성공)
+   */
+  bool room(void) const;
+
+  /**
+   * @brief 아직 버스에 나가지 않은 프레임 수 (큐 + TX 버퍼)
+   */
+  uint8_t pending(void) const;
+
+  /**
+   * @brief 전송 완료 인터럽트 처리 (INT 핀 ISR에서 호출)
+   *
+   * 완료 플래그가 남지 않을 때까지 끝난 버퍼의 프레임을 완료로 알리고
+   * 버퍼를 큐의 프레임으로 다시 채웁니다. 플래그가 남으면 INT 핀이 LOW에
+   * 머물러 다음 하강 에지가 생기지 않습니다.
+   */
+  void service(void);
+
+  /**
+   * @brief 큐와 TX 버퍼의 프레임을 모두 버림 (버스 오류 등으로 막혔을 때)
+   * @return 버스에 나가지 못하고 버린 프레임 수
+   *
+   * 중단 전에 전송을 마친 버퍼의 프레임은 완료로, 나머지는 버퍼에 채운
+   * 순서와 큐 순서대로 실패로 알립니다.
+   */
+  uint8_t abort(void);
+
+private:
+  /// 큐 항목 (표준 ID 프레임)
+  struct Frame {
+    uint16_t id;     ///< 표준 CAN ID
+    uint8_t len;     ///< 데이터 길이
+    uint8_t data[8]; ///< 데이터
+    void *tag;       ///< 전송 결과 알림 함수에 넘길 값
+  };
+
+  MiniMacCan &can;              ///< 대상 컨트롤러
+  MiniMacCanTxDone done;        ///< 전송 결과 알림 함수
+  Frame q[MINIMAC_CAN_TXQ_LEN]; ///< 송신 큐 (링 버퍼)
+  volatile uint8_t head;        ///< 다음에 넣을 위치 (계속 증가)
+  volatile uint8_t tail;        ///< 다음에 버퍼로 옮길 위치 (계속 증가)
+  volatile uint8_t busy;        ///< 전송 대기 중인 TX 버퍼 (bit n = TXBn)
+  volatile uint8_t prio;        ///< 마지막으로 채운 버퍼의 우선순위
+
+  /// TX 버퍼에 채운 프레임의 태그 (채운 순서 링 버퍼, 버퍼 3개 + 여유 1)
+  void *fly[4];
+  volatile uint8_t fly_head; ///< 다음에 채울 위치 (계속 증가)
+  volatile uint8_t fly_tail; ///< 다음에 알릴 위치 (계속 증가)
+
+  void fill(void);
+  void report(uint8_t bufs, bool sent);
+};
+
+#endif // MINIMAC_CAN_H
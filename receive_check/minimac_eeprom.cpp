@@ -0,0 +1,101 @@
+/**
+ * @file minimac_eeprom.cpp
+ * @brief Mini-MAC EEPROM 지연 쓰기 큐 (EE_READY 인터럽트 구동)
+ */
+
+#include "minimac_eeprom.h"
+
+static_assert(MINIMAC_EE_QUEUE_LEN >= 2 && MINIMAC_EE_QUEUE_LEN <= 255,
+              "MINIMAC_EE_QUEUE_LEN must be in 2..255");
+
+#if defined(__AVR__) && defined(EE_READY_vect)
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/// 쓰기 요청 항목 (주소, 값)
+typedef struct {
+  uint16_t addr;
+  uint8_t val;
+} EeWrite;
+
+static EeWrite ee_q[MINIMAC_EE_QUEUE_LEN]; ///< 쓰기 요청 링 버퍼
+static volatile uint8_t ee_head;           ///< 다음에 넣을 위치 (메인 루프)
+static volatile uint8_t ee_tail;           ///< 다음에 꺼낼 위치 (ISR)
+
+static uint8_t ee_next(uint8_t i) {
+  return (uint8_t)(i + 1) == MINIMAC_EE_QUEUE_LEN ? 0 : i + 1;
+}
+
+/**
+ * @brief EEPROM 준비 인터럽트: 큐에서 다음 바이트를 꺼내 기록 시작
+ *
+ * 이미 같은 값이 들어 있는 주소는 건너뛰고(update 의미), 실제로 바뀌는
+ * 바이트 하나의 기록을 시작한 뒤 반환한다. 기록이 끝나면(EEPE 해제) 이
+ * 인터럽트가 다시 발생한다. 큐가 비면 인터럽트를 끈다.
+ */
+ISR(EE_READY_vect) {
+  uint8_t t = ee_tail;
+  while (t != ee_head) {
+    EeWrite w = ee_q[t];
+    t = ee_next(t);
+
+    EEAR = w.addr;
+    EECR |= _BV(EERE);
+    if (EEDR != w.val) {
+      EEDR = w.val;
+      EECR |= _BV(EEMPE);
+      EECR |= _BV(EEPE);
+      ee_tail = t;
+      return;
+    }
+  }
+  ee_tail = t;
+  EECR &= ~_BV(EERIE);
+}
+
+void minimac_ee_write(int addr, uint8_t val) {
+  uint8_t h = ee_head;
+  uint8_t next = ee_next(h);
+
+  /* 큐가 가득 찼으면 ISR이 한 칸 비울 때까지 대기 */
+  while (next == ee_tail)
+    ;
+
+  ee_q[h].addr = (uint16_t)addr;
+  ee_q[h].val = val;
+  /* 항목 저장이 ee_head 갱신(ISR에 공개) 뒤로 밀리지 않도록 */
+  asm volatile("" ::: "memory");
+  ee_head = next;
+
+  /* EEPE가 해제돼 있으면 즉시 인터럽트가 걸려 기록이 시작됨 */
+  EECR |= _BV(EERIE);
+}
+
+void minimac_ee_flush(void) {
+  while (ee_tail != ee_head || (EECR & _BV(EEPE)))
+    ;
+}
+
+uint8_t minimac_ee_pending(void) {
+  uint8_t h = ee_head, t = ee_tail;
+  uint8_t n = h >= t ? h - t : MINIMAC_EE_QUEUE_LEN - t + h;
+  return n + ((EECR & _BV(EEPE)) ? 1 : 0);
+}
+
+#else // !__AVR__
+
+/* AVR 외 환경(에뮬레이션 EEPROM 등): 큐 없이 바로 기록 */
+void minimac_ee_write(int addr, uint8_t val) { EEPROM.update(addr, val); }
+
+void minimac_ee_flush(void) {}
+
+uint8_t minimac_ee_pending(void) { return 0; }
+
+#endif // __AVR__
+
+void minimac_ee_put(int addr, const void *src, uint16_t len) {
+  const uint8_t *p = (const uint8_t *)src;
+  for (uint16_t i = 0; i < len; i++)
+    minimac_ee_write(addr + i, p[i]);
+}
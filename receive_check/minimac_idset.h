@@ -0,0 +1,224 @@
+/**
+ * @file minimac_idset.h
+ * @brief 보호 대상 CAN ID 집합의 컴파일 시간 완전 해시(perfect hash) 분류기
+ *
+ * 빌드 시점에 정해진 보호 대상 ID 목록(ID, λ, 태그 길이)을 템플릿 인자로
+ * 받아, 충돌 없는 곱셈 해시 h(id) = (id × M mod 2^16) >> S 의 배수 M과
+ * 테이블 크기를 constexpr로 찾고 버킷 테이블을 플래시(PROGMEM)에 만듭니다.
+ * 수신 프레임 분류는 곱셈 한 번, 시프트, 플래시 읽기와 비교 한 번으로
+ * 끝나며 ID 개수와 무관하고 SRAM을 쓰지 않습니다.
+ *
+ * @code
+ * typedef MiniMacIdSet<minimac_id_spec(0x123), minimac_id_spec(0x2A0)> Ids;
+ *
+ * int16_t i = Ids::find(rxId);  // 목록 순서 번호, 보호 대상이 아니면 -1
+ * @endcode
+ *
+ * 목록 순서 번호 i는 setup()에서 Ids::id(i)를 i = 0부터 차례로
+ * minimac_add()에 Ids::lambda(i), Ids::tag_len(i)와 함께 넘기면
+ * minimac_ctx_at(i)의 컨텍스트 번호와 같아집니다. 목록의 λ와 태그 길이는
+ * 컨텍스트 테이블의 상한 MINIMAC_HIST_MAX/MINIMAC_TAG_MAX 이하여야 합니다
+ * (컴파일 시 검사).
+ */
+#ifndef MINIMAC_IDSET_H
+#define MINIMAC_IDSET_H
+
+#include "minimac.h"
+
+/**
+ * @brief 보호 대상 ID 하나의 설정을 템플릿 인자용 32비트 값으로 묶음
+ * @param can_id  보호할 CAN ID (11비트 표준 ID 또는 16비트 그룹 ID)
+ * @param lambda  메시지 히스토리 길이 λ
+ * @param tag_len 태그 길이(Byte)
+ * @return can_id | λ << 16 | tag_len << 24
+ */
+constexpr uint32_t minimac_id_spec(uint16_t can_id,
+                                   uint8_t lambda = MINIMAC_HIST_LEN,
+                                   uint8_t tag_len = MINIMAC_TAG_LEN) {
+  return (uint32_t)can_id | (uint32_t)lambda << 16 | (uint32_t)tag_len << 24;
+}
+
+/* ---- 컴파일 시간 계산용 내부 함수 (C++11 constexpr: 재귀 깊이 O(n)) ---- */
+
+/// 곱셈 해시: 16비트 곱의 상위 비트를 버킷 번호로 사용
+constexpr uint16_t mm_ph_bucket(uint16_t id, uint16_t mul, uint8_t shift) {
+  return (uint16_t)((unsigned)id * mul) >> shift;
+}
+
+/// 목록 s[i]의 버킷이 s[j..n-1] 중 하나와 겹치는지
+constexpr bool mm_ph_clash_one(const uint32_t *s, uint16_t n, uint16_t mul,
+                               uint8_t shift, uint16_t i, uint16_t j) {
+  return j < n &&
+         (mm_ph_bucket((uint16_t)s[i], mul, shift) ==
+              mm_ph_bucket((uint16_t)s[j], mul, shift) ||
+          mm_ph_clash_one(s, n, mul, shift, i, j + 1));
+}
+
+/// 목록 s[i..n-1]에 버킷이 겹치는 쌍이 있는지
+constexpr bool mm_ph_clash(const uint32_t *s, uint16_t n, uint16_t mul,
+                           uint8_t shift, uint16_t i = 0) {
+  return i < n && (mm_ph_clash_one(s, n, mul, shift, i, i + 1) ||
+                   mm_ph_clash(s, n, mul, shift, i + 1));
+}
+
+/// 목록 s[i]와 같은 CAN ID가 s[j..n-1]에 있는지
+constexpr bool mm_ph_dup_one(const uint32_t *s, uint16_t n, uint16_t i,
+                             uint16_t j) {
+  return j < n &&
+         ((uint16_t)s[i] == (uint16_t)s[j] || mm_ph_dup_one(s, n, i, j + 1));
+}
+
+/// 목록에 같은 CAN ID가 두 번 있는지 (해시와 무관하게 항상 충돌)
+constexpr bool mm_ph_dup(const uint32_t *s, uint16_t n, uint16_t i = 0) {
+  return i < n && (mm_ph_dup_one(s, n, i, i + 1) || mm_ph_dup(s, n, i + 1));
+}
+
+/// 목록의 λ와 태그 길이가 모두 1 이상, 컨텍스트 테이블 상한 이하인지
+constexpr bool mm_ph_cfg_ok(const uint32_t *s, uint16_t n, uint16_t i = 0) {
+  return i >= n || ((uint8_t)(s[i] >> 16) >= 1 &&
+                    (uint8_t)(s[i] >> 16) <= MINIMAC_HIST_MAX &&
+                    (uint8_t)(s[i] >> 24) >= 1 &&
+                    (uint8_t)(s[i] >> 24) <= MINIMAC_TAG_MAX &&
+                    mm_ph_cfg_ok(s, n, i + 1));
+}
+
+constexpr uint16_t mm_ph_search(const uint32_t *s, uint16_t n, uint8_t shift,
+                                uint16_t lo, uint16_t hi);
+
+/// 왼쪽 절반에서 찾았으면 그 값, 아니면 오른쪽 절반 탐색
+constexpr uint16_t mm_ph_pick(uint16_t found, const uint32_t *s, uint16_t n,
+                              uint8_t shift, uint16_t mid, uint16_t hi) {
+  return found ? found : mm_ph_search(s, n, shift, mid, hi);
+}
+
+/**
+ * 홀수 배수 2k + 1 (k ∈ [lo, hi)) 중 충돌 없는 첫 값, 없으면 0.
+ * 구간을 반으로 나눠 재귀하므로 재귀 깊이는 log2(hi - lo)이다.
+ */
+constexpr uint16_t mm_ph_search(const uint32_t *s, uint16_t n, uint8_t shift,
+                                uint16_t lo, uint16_t hi) {
+  return hi - lo == 1
+             ? (mm_ph_clash(s, n, (uint16_t)(2 * lo + 1), shift)
+                    ? 0
+                    : (uint16_t)(2 * lo + 1))
+             : mm_ph_pick(mm_ph_search(s, n, shift, lo, lo + (hi - lo) / 2),
+                          s, n, shift, lo + (hi - lo) / 2, hi);
+}
+
+/// 배수 탐색 범위 (홀수 배수 개수)
+static const uint16_t MM_PH_TRIES = 1024;
+
+/// 적재율 1/2 이하가 되는 최소 버킷 비트 수
+constexpr uint8_t mm_ph_min_bits(uint16_t n, uint8_t b = 1) {
+  return (1u << b) >= 2u * n ? b : mm_ph_min_bits(n, b + 1);
+}
+
+/// 충돌 없는 배수가 있는 최소 버킷 비트 수 (최소값에서 두 단계까지 시도)
+constexpr uint8_t mm_ph_bits(const uint32_t *s, uint16_t n, uint8_t b,
+                             uint8_t last) {
+  return b >= last || mm_ph_search(s, n, 16 - b, 0, MM_PH_TRIES)
+             ? b
+             : mm_ph_bits(s, n, b + 1, last);
+}
+
+/// 버킷 b에 놓일 목록 순서 번호, 빈 버킷이면 n
+constexpr uint16_t mm_ph_slot(const uint32_t *s, uint16_t n, uint16_t mul,
+                              uint8_t shift, uint16_t b, uint16_t i = 0) {
+  return i >= n || mm_ph_bucket((uint16_t)s[i], mul, shift) == b
+             ? i
+             : mm_ph_slot(s, n, mul, shift, b, i + 1);
+}
+
+template <uint16_t... I> struct mm_ph_seq {};
+template <uint16_t N, uint16_t... I>
+struct mm_ph_make_seq : mm_ph_make_seq<N - 1, N - 1, I...> {};
+template <uint16_t... I> struct mm_ph_make_seq<0, I...> {
+  typedef mm_ph_seq<I...> type;
+};
+
+/// 완전 해시 버킷 항목 (플래시에 저장)
+typedef struct {
+  uint16_t id;   ///< 버킷의 CAN ID (빈 버킷은 다른 버킷의 ID로 채워 항상 불일치)
+  uint8_t index; ///< ID 목록 순서 번호
+} MiniMacIdEntry;
+
+template <typename Set, typename Seq> struct MiniMacIdTable;
+
+/**
+ * @brief 컴파일 시간 완전 해시로 만든 보호 대상 CAN ID 집합
+ * @tparam Specs minimac_id_spec()으로 만든 ID 설정 목록 (중복 불가, 최대 32개)
+ */
+template <uint32_t... Specs> class MiniMacIdSet {
+public:
+  /// 보호 대상 ID 개수
+  static constexpr uint16_t count = sizeof...(Specs);
+
+  /// ID 설정 목록 (목록 순서, 플래시)
+  static constexpr uint32_t specs[count] PROGMEM = {Specs...};
+
+  static_assert(count >= 1 && count <= 32, "MiniMacIdSet needs 1..32 IDs");
+  static_assert(!mm_ph_dup(specs, count), "MiniMacIdSet has a duplicate ID");
+  static_assert(mm_ph_cfg_ok(specs, count),
+                "per-ID lambda/tag length out of 1..MINIMAC_HIST_MAX/TAG_MAX");
+
+  /// 버킷 비트 수, 배수, 시프트 (컴파일 시 결정)
+  static constexpr uint8_t min_bits = mm_ph_min_bits(count);
+  static constexpr uint8_t bits =
+      mm_ph_bits(specs, count, min_bits, min_bits + 2);
+  static constexpr uint8_t shift = 16 - bits;
+  static constexpr uint16_t mul =
+      mm_ph_search(specs, count, shift, 0, MM_PH_TRIES);
+  static constexpr uint16_t buckets = 1u << bits;
+
+  static_assert(mul != 0, "MiniMacIdSet: no collision-free multiplier found");
+
+  /**
+   * @brief 수신 CAN ID를 목록 순서 번호로 분류
+   * @param can_id 수신 프레임 ID (확장 ID면 bit 31이 켜진 값도 가능)
+   * @return 목록 순서 번호, 보호 대상이 아니면 -1
+   */
+  static int16_t find(uint32_t can_id) {
+    if (can_id > 0xFFFF)
+      return -1;
+    const MiniMacIdEntry *e = &Table::table[mm_ph_bucket(can_id, mul, shift)];
+    if (pgm_read_word(&e->id) != (uint16_t)can_id)
+      return -1;
+    return pgm_read_byte(&e->index);
+  }
+
+  /// 목록 i번째 CAN ID
+  static uint16_t id(uint16_t i) { return (uint16_t)spec(i); }
+
+  /// 목록 i번째 ID의 히스토리 길이 λ
+  static uint8_t lambda(uint16_t i) { return (uint8_t)(spec(i) >> 16); }
+
+  /// 목록 i번째 ID의 태그 길이(Byte)
+  static uint8_t tag_len(uint16_t i) { return (uint8_t)(spec(i) >> 24); }
+
+private:
+  typedef MiniMacIdTable<MiniMacIdSet,
+                         typename mm_ph_make_seq<buckets>::type>
+      Table;
+
+  static uint32_t spec(uint16_t i) { return pgm_read_dword(&specs[i]); }
+};
+
+template <uint32_t... Specs>
+constexpr uint32_t MiniMacIdSet<Specs...>::specs[MiniMacIdSet<Specs...>::count]
+    PROGMEM;
+
+/// 버킷 테이블: 버킷 번호 B마다 항목 하나를 컴파일 시 계산해 플래시에 둔다.
+template <typename Set, uint16_t... B>
+struct MiniMacIdTable<Set, mm_ph_seq<B...> > {
+  static constexpr uint16_t slot(uint16_t b) {
+    return mm_ph_slot(Set::specs, Set::count, Set::mul, Set::shift, b);
+  }
+  static const MiniMacIdEntry table[sizeof...(B)] PROGMEM;
+};
+
+template <typename Set, uint16_t... B>
+const MiniMacIdEntry MiniMacIdTable<Set, mm_ph_seq<B...> >::table[sizeof...(B)]
+    PROGMEM = {{(uint16_t)Set::specs[slot(B) < Set::count ? slot(B) : 0],
+                (uint8_t)slot(B)}...};
+
+#endif // MINIMAC_IDSET_H
@@ -0,0 +1,35 @@
+/**
+ * @file minimac_log.cpp
+ * @brief Mini-MAC 로그 출력 보조 함수 (로그가 꺼진 빌드에서는 비어 있음)
+ */
+
+#include "minimac_log.h"
+
+#if MINIMAC_LOG_LEVEL > MINIMAC_LOG_OFF
+
+void minimac_log_hex(const uint8_t *buf, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++) {
+    if (buf[i] < 0x10)
+      Serial.print('0');
+    Serial.print(buf[i], HEX);
+    Serial.print(' ');
+  }
+  Serial.println();
+}
+
+void minimac_log_u64(uint64_t v) {
+  if (v == 0) {
+    Serial.print('0');
+    return;
+  }
+  char buf[21]; // 최대 20자리 숫자 + 널 종료
+  buf[20] = '\0';
+  int pos = 19;
+  while (v > 0 && pos >= 0) {
+    buf[pos--] = '0' + (v % 10);
+    v /= 10;
+  }
+  Serial.print(&buf[pos + 1]);
+}
+
+#endif // MINIMAC_LOG_LEVEL > MINIMAC_LOG_OFF
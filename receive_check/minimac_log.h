@@ -0,0 +1,111 @@
+/**
+ * @file minimac_log.h
+ * @brief Mini-MAC 컴파일 타임 로그 레벨 설정
+ *
+ * MINIMAC_LOG_LEVEL 이하의 레벨만 Serial 출력 코드로 전개되고, 그보다 상세한
+ * 레벨의 매크로는 빈 문장((void)0)으로 치환됩니다. 비활성 레벨은 문자열
+ * 리터럴과 함수 호출까지 모두 컴파일 단계에서 제거되므로 서명/검증 경로에
+ * 로그 비용이 남지 않습니다.
+ *
+ * 기본값(MINIMAC_LOG_TRACE)은 기존 디버그 출력을 그대로 유지합니다. 양산
+ * 빌드에서는 아래 기본값을 바꾸거나 빌드 옵션으로 레벨을 지정합니다.
+ * @code
+ * arduino-cli compile --build-property \
+ *   "compiler.cpp.extra_flags=-DMINIMAC_LOG_LEVEL=MINIMAC_LOG_ERROR" ...
+ * @endcode
+ */
+#ifndef MINIMAC_LOG_H
+#define MINIMAC_LOG_H
+
+#include <Arduino.h>
+
+//=== 로그 레벨 ===
+/** @def MINIMAC_LOG_OFF
+ *  @brief 로그 출력 없음 (Serial 미사용)
+ */
+#define MINIMAC_LOG_OFF 0
+
+/** @def MINIMAC_LOG_ERROR
+ *  @brief 초기화 실패, 전송 실패, 인증 실패 등 오류만 출력
+ */
+#define MINIMAC_LOG_ERROR 1
+
+/** @def MINIMAC_LOG_INFO
+ *  @brief 초기화 완료, 송수신 결과 등 동작 요약 출력
+ */
+#define MINIMAC_LOG_INFO 2
+
+/** @def MINIMAC_LOG_DEBUG
+ *  @brief 서명/검증 단계, 태그, 카운터 변화 등 프레임별 디버그 출력
+ */
+#define MINIMAC_LOG_DEBUG 3
+
+/** @def MINIMAC_LOG_TRACE
+ *  @brief 다이제스트 입력 필드, EEPROM 저장 내용까지 모두 덤프
+ */
+#define MINIMAC_LOG_TRACE 4
+
+/** @def MINIMAC_LOG_LEVEL
+ *  @brief 컴파일 시 선택되는 로그 레벨 (기본: MINIMAC_LOG_TRACE)
+ */
+#ifndef MINIMAC_LOG_LEVEL
+#define MINIMAC_LOG_LEVEL MINIMAC_LOG_TRACE
+#endif
+
+#if MINIMAC_LOG_LEVEL > MINIMAC_LOG_OFF
+/**
+ * @brief 바이트 배열을 16진수로 출력 (각 바이트 뒤 공백, 마지막에 줄바꿈)
+ * @param buf   출력할 바이트 배열
+ * @param len   배열 길이(Byte)
+ */
+void minimac_log_hex(const uint8_t *buf, uint16_t len);
+
+/**
+ * @brief 64비트 부호 없는 정수를 10진수 문자열로 출력
+ * @param v     출력할 64비트 값
+ */
+void minimac_log_u64(uint64_t v);
+#endif
+
+//=== 레벨별 출력 매크로 ===
+#if MINIMAC_LOG_LEVEL >= MINIMAC_LOG_ERROR
+#define MM_ERROR(...) Serial.print(__VA_ARGS__)
+#define MM_ERRORLN(...) Serial.println(__VA_ARGS__)
+#else
+#define MM_ERROR(...) ((void)0)
+#define MM_ERRORLN(...) ((void)0)
+#endif
+
+#if MINIMAC_LOG_LEVEL >= MINIMAC_LOG_INFO
+#define MM_INFO(...) Serial.print(__VA_ARGS__)
+#define MM_INFOLN(...) Serial.println(__VA_ARGS__)
+#else
+#define MM_INFO(...) ((void)0)
+#define MM_INFOLN(...) ((void)0)
+#endif
+
+#if MINIMAC_LOG_LEVEL >= MINIMAC_LOG_DEBUG
+#define MM_DEBUG(...) Serial.print(__VA_ARGS__)
+#define MM_DEBUGLN(...) Serial.println(__VA_ARGS__)
+#define MM_DEBUG_HEX(buf, len) minimac_log_hex((buf), (len))
+#define MM_DEBUG_U64(v) minimac_log_u64(v)
+#else
+#define MM_DEBUG(...) ((void)0)
+#define MM_DEBUGLN(...) ((void)0)
+#define MM_DEBUG_HEX(buf, len) ((void)0)
+#define MM_DEBUG_U64(v) ((void)0)
+#endif
+
+#if MINIMAC_LOG_LEVEL >= MINIMAC_LOG_TRACE
+#define MM_TRACE(...) Serial.print(__VA_ARGS__)
+#define MM_TRACELN(...) Serial.println(__VA_ARGS__)
+#define MM_TRACE_HEX(buf, len) minimac_log_hex((buf), (len))
+#define MM_TRACE_U64(v) minimac_log_u64(v)
+#else
+#define MM_TRACE(...) ((void)0)
+#define MM_TRACELN(...) ((void)0)
+#define MM_TRACE_HEX(buf, len) ((void)0)
+#define MM_TRACE_U64(v) ((void)0)
+#endif
+
+#endif // MINIMAC_LOG_H
@@ -0,0 +1,160 @@
+/**
+ * @file minimac_mac.h
+ * @brief Mini-MAC 엔진이 쓰는 MAC 백엔드 (HMAC-MD5, Chaskey, SipHash-2-4)
+ *
+ * MiniMac 엔진은 다이제스트 입력(카운터 ‖ CAN ID ‖ 히스토리 ‖ 페이로드)을
+ * 조각 단위로 백엔드에 흘려 넣고, 결과의 앞 TagLen바이트를 태그로 씁니다.
+ * 백엔드는 다음 인터페이스를 갖춘 클래스이며 엔진의 템플릿 인자로 고릅니다.
+ *
+ *  - KEY_MIN, KEY_MAX, DIGEST_LEN: 허용 키 길이와 출력 길이(Byte)
+ *  - State: 다이제스트 하나를 계산하는 동안의 임시 상태 (스택)
+ *  - key(): 키 설정 및 선계산, begin()/update()/end(): 스트리밍 계산
+ *
+ * HMAC-MD5는 프레임당 MD5 압축 2회(키 패드 선계산 후)가 필요해 8비트 AVR에서
+ * 가장 느립니다. 양쪽 노드를 모두 바꿀 수 있는 고주기 ID에는 32비트 덧셈·
+ * 회전·XOR만 쓰는 Chaskey나 SipHash-2-4를 고르면 몇 배 빨라집니다. 태그는
+ * 알고리즘마다 다르므로 송수신 노드가 같은 백엔드를 써야 합니다.
+ */
+#ifndef MINIMAC_MAC_H
+#define MINIMAC_MAC_H
+
+#include <Arduino.h>
+
+#include "minimac.h"
+#include "minimac_md5.h"
+
+/**
+ * @class MiniMacHmacMd5
+ * @brief HMAC-MD5 백엔드 (기본값, 기존 노드와 태그 호환)
+ *
+ * 키가 고정되어 있으므로 (K ⊕ ipad), (K ⊕ opad) 블록의 MD5 압축 결과를
+ * key()에서 한 번만 계산해 두고, 매 다이제스트는 그 중간 상태에서 재개한다.
+ * MD5는 라이브러리 대신 AVR용 자체 구현(minimac_md5.h)을 쓰며, 결과는
+ * ArduinoMD5의 MD5::hmac_md5(입력 전체, key, ...)와 비트 단위로 같다.
+ */
+class MiniMacHmacMd5 {
+public:
+  static constexpr uint8_t KEY_MIN = 1;     ///< 최소 키 길이(Byte)
+  static constexpr uint8_t KEY_MAX = 64;    ///< 최대 키 길이 (MD5 블록 하나)
+  static constexpr uint8_t DIGEST_LEN = 16; ///< 출력 길이(Byte)
+
+  typedef MiniMacMd5 State;
+
+  void key(const uint8_t *key, uint8_t key_len);
+  void begin(State *st) const {
+    minimac_md5_resume(st, istate, MINIMAC_MD5_BLOCK_LEN);
+  }
+  void update(State *st, const void *data, uint16_t len) const {
+    minimac_md5_update(st, data, len);
+  }
+  void end(State *st, uint8_t *digest) const;
+
+private:
+  uint32_t istate[4]; ///< (K ⊕ ipad) 흡수 후 MD5 상태
+  uint32_t ostate[4]; ///< (K ⊕ opad) 흡수 후 MD5 상태
+};
+
+/**
+ * @class MiniMacChaskey
+ * @brief Chaskey-12 (Chaskey-LTS) 백엔드: 128비트 키, 128비트 출력
+ *
+ * 32비트 덧셈·회전·XOR로 된 순열을 16바이트 블록마다 한 번 돌리는
+ * Even-Mansour 방식 MAC이다. 곱셈이나 표 조회가 없어 AVR에서 MD5보다 훨씬
+ * 가볍다. 부분 키 K1, K2는 end()에서 K를 두 배(GF(2^128))해 만들므로 키
+ * 상태는 16바이트뿐이다.
+ */
+class MiniMacChaskey {
+public:
+  static constexpr uint8_t KEY_MIN = 16;
+  static constexpr uint8_t KEY_MAX = 16;
+  static constexpr uint8_t DIGEST_LEN = 16;
+
+  /// 순열 라운드 수 (Chaskey-LTS)
+  static constexpr uint8_t ROUNDS = 12;
+
+  typedef struct {
+    uint32_t v[4];   ///< 체이닝 값
+    uint8_t buf[16]; ///< 아직 흡수하지 않은 블록 (마지막 블록 판단용)
+    uint8_t fill;    ///< buf에 채워진 바이트 수
+  } State;
+
+  void key(const uint8_t *key, uint8_t key_len);
+  void begin(State *st) const;
+  void update(State *st, const void *data, uint16_t len) const;
+  void end(State *st, uint8_t *digest) const;
+
+private:
+  uint32_t k[4]; ///< 키 (리틀 엔디언 32비트 워드)
+};
+
+/**
+ * @class MiniMacSipHash
+ * @brief SipHash-2-4 백엔드: 128비트 키, 64비트 출력
+ *
+ * 8바이트 블록마다 SipRound 2회, 끝에서 4회를 돈다. 출력이 8바이트이므로
+ * 태그 길이도 8바이트 이하여야 한다.
+ */
+class MiniMacSipHash {
+public:
+  static constexpr uint8_t KEY_MIN = 16;
+  static constexpr uint8_t KEY_MAX = 16;
+  static constexpr uint8_t DIGEST_LEN = 8;
+
+  typedef struct {
+    uint64_t v[4];  ///< 내부 상태 v0..v3
+    uint8_t buf[8]; ///< 아직 흡수하지 않은 바이트
+    uint8_t fill;   ///< buf에 채워진 바이트 수
+    uint8_t total;  ///< 입력 전체 길이 mod 256 (마지막 블록에 넣음)
+  } State;
+
+  void key(const uint8_t *key, uint8_t key_len);
+  void begin(State *st) const;
+  void update(State *st, const void *data, uint16_t len) const;
+  void end(State *st, uint8_t *digest) const;
+
+private:
+  uint64_t k0, k1; ///< 키 (리틀 엔디언 64비트 워드)
+};
+
+/**
+ * @class MiniMacAnyMac
+ * @brief 실행 시 고르는 MAC 백엔드 (컨텍스트 테이블용)
+ *
+ * select()로 고른 알고리즘(MiniMacAlg)에 따라 세 백엔드 중 하나로 분기한다.
+ * 키 상태는 공용체에 두므로 크기는 가장 큰 백엔드(HMAC-MD5) + 1바이트이다.
+ * 출력 길이는 가장 짧은 SipHash에 맞춰 8바이트이다. select()는 key()
+ * 전에 호출하며, 호출하지 않은 전역 객체는 HMAC-MD5이다.
+ */
+class MiniMacAnyMac {
+public:
+  static constexpr uint8_t KEY_MIN = MiniMacHmacMd5::KEY_MIN;
+  static constexpr uint8_t KEY_MAX = MiniMacHmacMd5::KEY_MAX;
+  static constexpr uint8_t DIGEST_LEN = MiniMacSipHash::DIGEST_LEN;
+
+  typedef union {
+    MiniMacHmacMd5::State md5;
+    MiniMacChaskey::State chaskey;
+    MiniMacSipHash::State sip;
+  } State;
+
+  /// 사용할 알고리즘 선택 (키 길이가 16바이트가 아니면 HMAC-MD5만 가능)
+  void select(MiniMacAlg alg) { this->alg = (uint8_t)alg; }
+
+  /// 선택된 알고리즘
+  MiniMacAlg algorithm(void) const { return (MiniMacAlg)alg; }
+
+  void key(const uint8_t *key, uint8_t key_len);
+  void begin(State *st) const;
+  void update(State *st, const void *data, uint16_t len) const;
+  void end(State *st, uint8_t *digest) const;
+
+private:
+  uint8_t alg; ///< 선택된 MiniMacAlg
+  union {
+    MiniMacHmacMd5 hmac;
+    MiniMacChaskey chaskey;
+    MiniMacSipHash sip;
+  } k; ///< 선택된 백엔드의 키 상태
+};
+
+#endif // MINIMAC_MAC_H
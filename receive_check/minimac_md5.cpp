@@ -0,0 +1,289 @@
+/**
+ * @file minimac_md5.cpp
+ * @brief Mini-MAC 전용 MD5 구현 (RFC 1321)
+ */
+
+#include "minimac_md5.h"
+#include "minimac.h"
+
+/// 리틀 엔디언 32비트 읽기 (메시지 워드)
+static inline uint32_t md5_load(const uint8_t *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+/// 리틀 엔디언 32비트 쓰기 (다이제스트, 길이)
+static inline void md5_store(uint8_t *p, uint32_t x) {
+  p[0] = (uint8_t)x;
+  p[1] = (uint8_t)(x >> 8);
+  p[2] = (uint8_t)(x >> 16);
+  p[3] = (uint8_t)(x >> 24);
+}
+
+/* 라운드 함수 (RFC 1321, F와 G는 연산 수를 줄인 동치식) */
+#define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+#if MINIMAC_MD5_UNROLL
+
+/**
+ * @brief 상수 N비트 왼쪽 회전
+ *
+ * AVR은 한 번에 1비트만 시프트하므로, 가장 가까운 8의 배수만큼은 바이트
+ * 단위 회전(레지스터 복사)으로 하고 남은 -4..+3비트만 비트 시프트한다.
+ * MD5 회전량 16가지가 모두 비트 시프트 4회 이하가 된다.
+ */
+template <uint8_t N> static inline uint32_t md5_rotl(uint32_t x) {
+#ifdef __AVR__
+  const uint8_t B = (N + 4) / 8 * 8 % 32;
+  if (B)
+    x = (x << B) | (x >> (32 - B));
+  if (N > B)
+    x = (x << (N - B)) | (x >> (32 - (N - B)));
+  else if (N < B)
+    x = (x >> (B - N)) | (x << (32 - (B - N)));
+  return x;
+#else
+  return (x << N) | (x >> (32 - N));
+#endif
+}
+
+/* 한 단계: a = b + ((a + f(b, c, d) + X[k] + T) <<< s) */
+#define MD5_STEP(f, a, b, c, d, k, t, s)                                       \
+  (a) += f((b), (c), (d)) + md5_load(block + 4 * (k)) + (uint32_t)(t);         \
+  (a) = md5_rotl<s>(a) + (b)
+
+/**
+ * @brief MD5 압축 함수 (64단계 전개)
+ * @param state 체이닝 값 a, b, c, d (입출력)
+ * @param block 입력 블록 (64바이트)
+ *
+ * 상수와 회전량, 메시지 워드 번호가 모두 컴파일 시 정해지므로 루프 카운터,
+ * 상수 표 조회, 가변 시프트가 없다. 메시지 워드는 복사하지 않고 블록에서
+ * 바로 읽는다.
+ */
+void minimac_md5_block(uint32_t state[4], const uint8_t *block) {
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+  /* (1) 라운드 1: F, X[i] */
+  MD5_STEP(MD5_F, a, b, c, d, 0, 0xd76aa478, 7);
+  MD5_STEP(MD5_F, d, a, b, c, 1, 0xe8c7b756, 12);
+  MD5_STEP(MD5_F, c, d, a, b, 2, 0x242070db, 17);
+  MD5_STEP(MD5_F, b, c, d, a, 3, 0xc1bdceee, 22);
+  MD5_STEP(MD5_F, a, b, c, d, 4, 0xf57c0faf, 7);
+  MD5_STEP(MD5_F, d, a, b, c, 5, 0x4787c62a, 12);
+  MD5_STEP(MD5_F, c, d, a, b, 6, 0xa8304613, 17);
+  MD5_STEP(MD5_F, b, c, d, a, 7, 0xfd469501, 22);
+  MD5_STEP(MD5_F, a, b, c, d, 8, 0x698098d8, 7);
+  MD5_STEP(MD5_F, d, a, b, c, 9, 0x8b44f7af, 12);
+  MD5_STEP(MD5_F, c, d, a, b, 10, 0xffff5bb1, 17);
+  MD5_STEP(MD5_F, b, c, d, a, 11, 0x895cd7be, 22);
+  MD5_STEP(MD5_F, a, b, c, d, 12, 0x6b901122, 7);
+  MD5_STEP(MD5_F, d, a, b, c, 13, 0xfd987193, 12);
+  MD5_STEP(MD5_F, c, d, a, b, 14, 0xa679438e, 17);
+  MD5_STEP(MD5_F, b, c, d, a, 15, 0x49b40821, 22);
+
+  /* (2) 라운드 2: G, X[(1 + 5i) mod 16] */
+  MD5_STEP(MD5_G, a, b, c, d, 1, 0xf61e2562, 5);
+  MD5_STEP(MD5_G, d, a, b, c, 6, 0xc040b340, 9);
+  MD5_STEP(MD5_G, c, d, a, b, 11, 0x265e5a51, 14);
+  MD5_STEP(MD5_G, b, c, d, a, 0, 0xe9b6c7aa, 20);
+  MD5_STEP(MD5_G, a, b, c, d, 5, 0xd62f105d, 5);
+  MD5_STEP(MD5_G, d, a, b, c, 10, 0x02441453, 9);
+  MD5_STEP(MD5_G, c, d, a, b, 15, 0xd8a1e681, 14);
+  MD5_STEP(MD5_G, b, c, d, a, 4, 0xe7d3fbc8, 20);
+  MD5_STEP(MD5_G, a, b, c, d, 9, 0x21e1cde6, 5);
+  MD5_STEP(MD5_G, d, a, b, c, 14, 0xc33707d6, 9);
+  MD5_STEP(MD5_G, c, d, a, b, 3, 0xf4d50d87, 14);
+  MD5_STEP(MD5_G, b, c, d, a, 8, 0x455a14ed, 20);
+  MD5_STEP(MD5_G, a, b, c, d, 13, 0xa9e3e905, 5);
+  MD5_STEP(MD5_G, d, a, b, c, 2, 0xfcefa3f8, 9);
+  MD5_STEP(MD5_G, c, d, a, b, 7, 0x676f02d9, 14);
+  MD5_STEP(MD5_G, b, c, d, a, 12, 0x8d2a4c8a, 20);
+
+  /* (3) 라운드 3: H, X[(5 + 3i) mod 16] */
+  MD5_STEP(MD5_H, a, b, c, d, 5, 0xfffa3942, 4);
+  MD5_STEP(MD5_H, d, a, b, c, 8, 0x8771f681, 11);
+  MD5_STEP(MD5_H, c, d, a, b, 11, 0x6d9d6122, 16);
+  MD5_STEP(MD5_H, b, c, d, a, 14, 0xfde5380c, 23);
+  MD5_STEP(MD5_H, a, b, c, d, 1, 0xa4beea44, 4);
+  MD5_STEP(MD5_H, d, a, b, c, 4, 0x4bdecfa9, 11);
+  MD5_STEP(MD5_H, c, d, a, b, 7, 0xf6bb4b60, 16);
+  MD5_STEP(MD5_H, b, c, d, a, 10, 0xbebfbc70, 23);
+  MD5_STEP(MD5_H, a, b, c, d, 13, 0x289b7ec6, 4);
+  MD5_STEP(MD5_H, d, a, b, c, 0, 0xeaa127fa, 11);
+  MD5_STEP(MD5_H, c, d, a, b, 3, 0xd4ef3085, 16);
+  MD5_STEP(MD5_H, b, c, d, a, 6, 0x04881d05, 23);
+  MD5_STEP(MD5_H, a, b, c, d, 9, 0xd9d4d039, 4);
+  MD5_STEP(MD5_H, d, a, b, c, 12, 0xe6db99e5, 11);
+  MD5_STEP(MD5_H, c, d, a, b, 15, 0x1fa27cf8, 16);
+  MD5_STEP(MD5_H, b, c, d, a, 2, 0xc4ac5665, 23);
+
+  /* (4) 라운드 4: I, X[7i mod 16] */
+  MD5_STEP(MD5_I, a, b, c, d, 0, 0xf4292244, 6);
+  MD5_STEP(MD5_I, d, a, b, c, 7, 0x432aff97, 10);
+  MD5_STEP(MD5_I, c, d, a, b, 14, 0xab9423a7, 15);
+  MD5_STEP(MD5_I, b, c, d, a, 5, 0xfc93a039, 21);
+  MD5_STEP(MD5_I, a, b, c, d, 12, 0x655b59c3, 6);
+  MD5_STEP(MD5_I, d, a, b, c, 3, 0x8f0ccc92, 10);
+  MD5_STEP(MD5_I, c, d, a, b, 10, 0xffeff47d, 15);
+  MD5_STEP(MD5_I, b, c, d, a, 1, 0x85845dd1, 21);
+  MD5_STEP(MD5_I, a, b, c, d, 8, 0x6fa87e4f, 6);
+  MD5_STEP(MD5_I, d, a, b, c, 15, 0xfe2ce6e0, 10);
+  MD5_STEP(MD5_I, c, d, a, b, 6, 0xa3014314, 15);
+  MD5_STEP(MD5_I, b, c, d, a, 13, 0x4e0811a1, 21);
+  MD5_STEP(MD5_I, a, b, c, d, 4, 0xf7537e82, 6);
+  MD5_STEP(MD5_I, d, a, b, c, 11, 0xbd3af235, 10);
+  MD5_STEP(MD5_I, c, d, a, b, 2, 0x2ad7d2bb, 15);
+  MD5_STEP(MD5_I, b, c, d, a, 9, 0xeb86d391, 21);
+
+  /* (5) 체이닝 값 누적 */
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+#else // !MINIMAC_MD5_UNROLL
+
+/// 단계별 덧셈 상수 T[i] = floor(2^32 × |sin(i + 1)|) (플래시)
+static const uint32_t MD5_T[64] PROGMEM = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+    0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+    0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+    0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+    0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+    0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+/// 라운드별 회전량 (라운드 r, 단계 i mod 4) (플래시)
+static const uint8_t MD5_S[16] PROGMEM = {7, 12, 17, 22, 5, 9,  14, 20,
+                                          4, 11, 16, 23, 6, 10, 15, 21};
+
+/**
+ * @brief MD5 압축 함수 (루프, 코드 크기 우선)
+ * @param state 체이닝 값 a, b, c, d (입출력)
+ * @param block 입력 블록 (64바이트)
+ */
+void minimac_md5_block(uint32_t state[4], const uint8_t *block) {
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+  for (uint8_t i = 0; i < 64; i++) {
+    uint32_t f;
+    uint8_t k;
+    switch (i >> 4) {
+    case 0:
+      f = MD5_F(b, c, d);
+      k = i;
+      break;
+    case 1:
+      f = MD5_G(b, c, d);
+      k = (1 + 5 * i) & 15;
+      break;
+    case 2:
+      f = MD5_H(b, c, d);
+      k = (5 + 3 * i) & 15;
+      break;
+    default:
+      f = MD5_I(b, c, d);
+      k = (7 * i) & 15;
+      break;
+    }
+    uint8_t s = pgm_read_byte(&MD5_S[(i >> 2 & 12) | (i & 3)]);
+    f += a + md5_load(block + 4 * k) + pgm_read_dword(&MD5_T[i]);
+    a = d;
+    d = c;
+    c = b;
+    b += (f << s) | (f >> (32 - s));
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+#endif // MINIMAC_MD5_UNROLL
+
+/**
+ * @brief 초기값(IV)에서 MD5 시작
+ */
+void minimac_md5_init(MiniMacMd5 *ctx) {
+  static const uint32_t iv[4] = {0x67452301, 0xefcdab89, 0x98badcfe,
+                                 0x10325476};
+  minimac_md5_resume(ctx, iv, 0);
+}
+
+/**
+ * @brief 블록 경계의 체이닝 값과 길이에서 MD5 재개
+ */
+void minimac_md5_resume(MiniMacMd5 *ctx, const uint32_t state[4],
+                        uint32_t len) {
+  memcpy(ctx->state, state, sizeof(ctx->state));
+  ctx->len = len;
+}
+
+/**
+ * @brief 입력 흡수
+ *
+ * 모아 둔 입력이 블록을 채우면 압축하고, 호출자 버퍼에서 블록 단위로
+ * 남은 부분은 복사하지 않고 바로 압축한다.
+ */
+void minimac_md5_update(MiniMacMd5 *ctx, const void *data, uint16_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint8_t fill = (uint8_t)(ctx->len % MINIMAC_MD5_BLOCK_LEN);
+  ctx->len += len;
+
+  /* (1) 모아 둔 입력이 있으면 블록을 채워 압축 */
+  if (fill) {
+    uint8_t n = MINIMAC_MD5_BLOCK_LEN - fill;
+    if (len < n) {
+      memcpy(ctx->buf + fill, p, len);
+      return;
+    }
+    memcpy(ctx->buf + fill, p, n);
+    minimac_md5_block(ctx->state, ctx->buf);
+    p += n;
+    len -= n;
+  }
+
+  /* (2) 온전한 블록은 호출자 버퍼에서 바로 압축 */
+  for (; len >= MINIMAC_MD5_BLOCK_LEN; len -= MINIMAC_MD5_BLOCK_LEN) {
+    minimac_md5_block(ctx->state, p);
+    p += MINIMAC_MD5_BLOCK_LEN;
+  }
+
+  /* (3) 남은 입력을 다음 호출까지 보관 */
+  memcpy(ctx->buf, p, len);
+}
+
+/**
+ * @brief 0x80, 0 패딩과 비트 길이(64비트 리틀 엔디언)로 마무리
+ */
+void minimac_md5_final(MiniMacMd5 *ctx, uint8_t *digest) {
+  uint8_t fill = (uint8_t)(ctx->len % MINIMAC_MD5_BLOCK_LEN);
+
+  /* (1) 0x80 뒤 0으로 채우고, 길이 8바이트가 들어갈 자리가 없으면 한 블록 더 */
+  ctx->buf[fill++] = 0x80;
+  if (fill > MINIMAC_MD5_BLOCK_LEN - 8) {
+    memset(ctx->buf + fill, 0, MINIMAC_MD5_BLOCK_LEN - fill);
+    minimac_md5_block(ctx->state, ctx->buf);
+    fill = 0;
+  }
+  memset(ctx->buf + fill, 0, MINIMAC_MD5_BLOCK_LEN - 8 - fill);
+
+  /* (2) 비트 길이 기록 후 마지막 블록 압축 */
+  md5_store(ctx->buf + 56, ctx->len << 3);
+  md5_store(ctx->buf + 60, ctx->len >> 29);
+  minimac_md5_block(ctx->state, ctx->buf);
+
+  /* (3) 체이닝 값을 리틀 엔디언으로 출력 */
+  for (uint8_t i = 0; i < 4; i++)
+    md5_store(digest + 4 * i, ctx->state[i]);
+}
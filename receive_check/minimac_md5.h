@@ -0,0 +1,68 @@
+/**
+ * @file minimac_md5.h
+ * @brief Mini-MAC 전용 MD5 (AVR용 압축 함수, HMAC 중간 상태 재개)
+ *
+ * HMAC-MD5 백엔드의 프레임당 비용은 거의 전부 MD5 압축 함수입니다. 이
+ * 모듈은 ArduinoMD5 라이브러리 대신 쓰는 자체 MD5로, 64단계를 모두 펼친
+ * 압축 함수(MINIMAC_MD5_UNROLL)에서 체이닝 값 a, b, c, d를 지역 변수로만
+ * 다뤄 레지스터에 머물게 하고, 라운드 상수는 명령어 즉값(플래시)으로
+ * 넣습니다. 회전은 가장 가까운 바이트 단위 이동과 1..4비트 시프트로 나눠
+ * AVR에서 바이트 복사로 처리되게 합니다. 펼치지 않는 빌드는 상수와 회전량을
+ * PROGMEM 표에서 읽는 작은 루프를 씁니다.
+ *
+ * 컨텍스트는 블록 경계의 체이닝 값과 길이에서 다시 시작할 수 있어, HMAC 키
+ * 패드 블록을 미리 압축해 둔 상태로 바로 이어 쓸 수 있습니다.
+ */
+#ifndef MINIMAC_MD5_H
+#define MINIMAC_MD5_H
+
+#include <Arduino.h>
+
+/// MD5 블록 크기(Byte)
+static const uint8_t MINIMAC_MD5_BLOCK_LEN = 64;
+
+/// MD5 스트리밍 계산 상태
+typedef struct {
+  uint32_t state[4]; ///< 체이닝 값 a, b, c, d
+  uint32_t len;      ///< 지금까지 흡수한 길이(Byte)
+  uint8_t buf[64];   ///< 블록이 차기 전까지 모아 둔 입력 (len % 64바이트)
+} MiniMacMd5;
+
+/**
+ * @brief MD5 압축 함수: 64바이트 블록 하나로 체이닝 값 갱신
+ * @param state 체이닝 값 a, b, c, d (입출력)
+ * @param block 입력 블록 (64바이트)
+ */
+void minimac_md5_block(uint32_t state[4], const uint8_t *block);
+
+/**
+ * @brief 초기값(IV)에서 MD5 시작
+ * @param ctx 초기화할 상태
+ */
+void minimac_md5_init(MiniMacMd5 *ctx);
+
+/**
+ * @brief 블록 경계에서 멈춘 체이닝 값으로 MD5 재개
+ * @param ctx   초기화할 상태
+ * @param state 블록 경계의 체이닝 값
+ * @param len   그때까지 흡수한 길이(Byte, 64의 배수)
+ */
+void minimac_md5_resume(MiniMacMd5 *ctx, const uint32_t state[4],
+                        uint32_t len);
+
+/**
+ * @brief 입력 흡수
+ * @param ctx  MD5 상태
+ * @param data 입력
+ * @param len  입력 길이(Byte)
+ */
+void minimac_md5_update(MiniMacMd5 *ctx, const void *data, uint16_t len);
+
+/**
+ * @brief 패딩과 길이를 넣어 마무리하고 16바이트 다이제스트 출력
+ * @param ctx    MD5 상태 (이후 다시 쓰려면 init/resume 필요)
+ * @param digest 결과 저장 버퍼 (16바이트)
+ */
+void minimac_md5_final(MiniMacMd5 *ctx, uint8_t *digest);
+
+#endif // MINIMAC_MD5_H
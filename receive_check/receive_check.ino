@@ -5,12 +5,16 @@
  * 이 파일은 Mini-MAC 기반의 메시지 인증을 적용하여 CAN 버스로 들어오는 메시지를
  * 검증하는 예제 코드입니다. 수신된 CAN 메시지의 ID와 인증 태그를 검사하여,
  * 유효한 메시지인지 여부를 판단합니다.
+ *
+ * MCP2515의 INT 핀 인터럽트에서 프레임을 SRAM 링 버퍼로 옮기고, 메인 루프는
+ * 링에 쌓인 프레임을 꺼내 검증합니다. 검증이 밀려도 컨트롤러의 수신 버퍼
+ * 2개는 곧바로 비워지므로 버스트 중에도 오버런이 생기지 않습니다.
  */
 
 #include "minimac.h"
-#include <EEPROM.h>
+#include "minimac_idset.h"
+#include "minimac_can.h"
 #include <SPI.h>
-#include <mcp_can.h>
 
 /**
  * @brief Mini-MAC 인증이 적용되는 보호 대상 CAN 메시지 식별자.
@@ -19,6 +23,31 @@
  */
 #define PROTECTED_ID 0x123
 
+/**
+ * @brief MCP2515 INT 핀이 연결된 아두이노 핀 (외부 인터럽트 가능 핀).
+ */
+#define CAN_INT_PIN 2
+
+/**
+ * @brief 수신 링 버퍼 크기(프레임 수, 2의 거듭제곱, 128 이하).
+ *
+ * 프레임 하나에 17바이트(AVR)를 쓰며, 검증 한 번이 걸리는 동안 버스에서
+ * 들어올 수 있는 프레임 수보다 넉넉하게 잡습니다.
+ */
+#define RX_RING_SIZE 16
+
+/**
+ * @brief 보호 대상 CAN ID 집합 (ID, λ, 태그 길이).
+ *
+ * 컴파일 시 완전 해시 테이블이 플래시에 만들어져, 수신 프레임 분류가 ID
+ * 개수와 무관한 상수 시간에 끝납니다. ID를 추가하려면 목록에 항목을 더하고
+ * minimac.h의 MINIMAC_MAX_CTX를 목록 길이 이상으로 늘립니다(모자라면 컴파일
+ * 오류).
+ */
+typedef MiniMacIdSet<minimac_id_spec(PROTECTED_ID)> ProtectedIds;
+static_assert(ProtectedIds::count <= MINIMAC_MAX_CTX,
+              "MINIMAC_MAX_CTX must be at least the number of protected IDs");
+
 /**
  * @brief Mini-MAC 프로토콜에 사용되는 16바이트 비밀 키.
  *
@@ -31,119 +60,221 @@ const uint8_t SECRET_KEY[MINIMAC_KEY_LEN] = {0x1A, 0x2B, 0x3C, 0x4D, 0x5E, 0x6F,
 /**
  * @brief CAN 버스 제어 객체.
  *
- * MCP2515 기반 CAN 트랜시버를 제어하는 MCP_CAN 인스턴스이며, CS 핀 10번을
- * 사용합니다.
+ * MCP2515 기반 CAN 트랜시버를 제어하는 MiniMacCan 드라이버 인스턴스이며, CS 핀
+ * 10번을 사용합니다.
+ */
+MiniMacCan CAN(10);
+
+/**
+ * @brief 수신 링 버퍼의 프레임 한 개.
+ */
+struct RxFrame {
+  uint32_t id;                                      ///< CAN ID
+  uint8_t len;                                      ///< 데이터 길이(DLC)
+  uint8_t data[MINIMAC_MAX_DATA + MINIMAC_TAG_MAX]; ///< 페이로드 ‖ 태그
+};
+
+RxFrame rxRing[RX_RING_SIZE]; ///< 수신 링 버퍼
+volatile uint8_t rxHead;      ///< 다음에 쓸 위치 (ISR만 증가, 계속 증가)
+volatile uint8_t rxTail;      ///< 다음에 읽을 위치 (loop만 증가, 계속 증가)
+volatile uint16_t rxDropped;  ///< 링이 가득 차 버린 프레임 수
+
+/**
+ * @brief MCP2515 수신 인터럽트 처리 함수.
+ *
+ * 컨트롤러 수신 버퍼에 남은 프레임을 모두 읽어 링 버퍼에 넣습니다. INT 핀은
+ * 수신 버퍼가 모두 비어야 올라가므로, 하강 에지를 놓치지 않도록 남은 프레임이
+ * 없을 때까지 읽습니다. 링이 가득 차면 프레임을 읽어 버리고 rxDropped를
+ * 늘립니다. 검증이나 시리얼 출력은 하지 않습니다.
+ */
+void canIsr() {
+  RxFrame scratch;
+  for (;;) {
+    uint8_t head = rxHead;
+    bool full = (uint8_t)(head - rxTail) == RX_RING_SIZE;
+    RxFrame *f = full ? &scratch : &rxRing[head & (RX_RING_SIZE - 1)];
+    if (!CAN.read(&f->id, &f->len, f->data))
+      break;
+    if (full)
+      rxDropped++;
+    else
+      rxHead = head + 1;
+  }
+}
+
+/**
+ * @brief minimac_can_filter로 계산한 마스크/필터를 MCP2515에 설정합니다.
+ *
+ * 필터는 표준 ID만 비교하므로 확장 ID 프레임은 수신 버퍼에 들어오지
+ * 않습니다. 설정 모드에서 호출합니다.
  */
-MCP_CAN CAN(10);
+void setupCanFilter() {
+  MiniMacCanFilter flt;
+  minimac_can_filter(&flt);
+  CAN.set_filter(flt.mask, flt.filt);
+}
 
 /**
  * @brief 수신기 시스템 초기화 함수로, 필요한 설정을 수행합니다.
  *
  * 시리얼 통신을 115200 baud로 시작하고 Serial 연결을 기다립니다.
- * EEPROM 메모리 내용을 0xFF로 모두 채워 초기화합니다.
- * CAN 컨트롤러를 초기화(all ID 수신, 500kbps, 16MHz 클럭) 후 정상
- * 모드(MCP_NORMAL)로 설정합니다. Mini-MAC 프로토콜을 PROTECTED_ID와
- * SECRET_KEY로 초기화하여 수신 시 인증 검증을 수행할 준비를 합니다. 설정이
- * 완료되면 시리얼 모니터에 "[INFO] Receiver Initialized" 메시지를 출력합니다.
+ * CAN 컨트롤러를 설정 모드로 초기화(500kbps, 16MHz 클럭)합니다.
+ * ProtectedIds의 ID를 목록 순서대로 SECRET_KEY와 함께 Mini-MAC 컨텍스트로
+ * 등록하여 수신 시 인증 검증을 수행할 준비를 합니다. 카운터와 히스토리는
+ * EEPROM에 저장된 상태를 이어 쓰며, 송신 노드와 어긋나 있으면 다음 재동기화
+ * 프레임(MINIMAC_RESYNC_ID)을 받을 때 맞춰집니다. 등록한 ID와 재동기화 ID로
+ * 하드웨어 마스크/필터를 설정해 관계없는 프레임은 SPI로 읽지 않게 한 뒤 정상
+ * 모드(MODE_NORMAL)로 바꾸고, CAN_INT_PIN의 하강 에지에 canIsr을 연결해 수신
+ * 프레임을 링 버퍼로 받습니다. 설정이 완료되면 시리얼 모니터에
+ * "[INFO] Receiver Initialized" 메시지를 출력합니다.
  */
 void setup() {
   Serial.begin(115200);
   while (!Serial)
     ;
 
-  // EEPROM 전체 초기화
-  for (int i = 0; i < EEPROM.length(); i++) {
-    EEPROM.write(i, 0xFF);
+  // CAN 초기화 (500kbps, 16MHz, 설정 모드에서 시작)
+  if (!CAN.begin(500, 16)) {
+    MM_ERRORLN("[ERROR] CAN Init Failed!");
+    for (;;)
+      ;
   }
 
-  // CAN 초기화 (all IDs, 500kbps, 16MHz)
-  if (CAN.begin(MCP_ANY, CAN_500KBPS, MCP_16MHZ) != CAN_OK) {
-    Serial.println("[ERROR] CAN Init Failed!");
+#if MINIMAC_SELFTEST
+  // MAC 자체 시험: 기준 벡터, ArduinoMD5와 비교, 블록당 사이클 출력
+  if (!minimac_selftest()) {
     for (;;)
       ;
   }
-  CAN.setMode(MCP_NORMAL);
+#endif
 
-  // Mini-MAC 초기화 (fresh 상태로 시작)
-  minimac_init(PROTECTED_ID, SECRET_KEY);
+  // 보호 대상 ID를 목록 순서대로 등록 (저장된 상태 이어 쓰기, 어긋난 상태는
+  // 재동기화 프레임으로 복구). 등록 순서 = ProtectedIds::find()가 돌려주는 번호
+  for (uint16_t i = 0; i < ProtectedIds::count; i++) {
+    if (!minimac_add(ProtectedIds::id(i), SECRET_KEY, MINIMAC_MAC_HMAC_MD5,
+                     ProtectedIds::lambda(i), ProtectedIds::tag_len(i))) {
+      MM_ERRORLN("[ERROR] minimac_add failed!");
+      for (;;)
+        ;
+    }
+  }
 
-  Serial.println("[INFO] Receiver Initialized");
+  // 하드웨어 필터: 보호 대상 ID와 재동기화 ID만 수신 버퍼로
+  setupCanFilter();
+  CAN.set_mode(MiniMacCan::MODE_NORMAL);
+
+  // INT 핀 인터럽트로 수신 (ISR에서 SPI를 쓰므로 SPI 라이브러리에 알림)
+  pinMode(CAN_INT_PIN, INPUT);
+  SPI.usingInterrupt(digitalPinToInterrupt(CAN_INT_PIN));
+  attachInterrupt(digitalPinToInterrupt(CAN_INT_PIN), canIsr, FALLING);
+  canIsr(); // 연결 전에 도착해 INT를 낮춘 프레임 비우기
+
+  MM_INFOLN("[INFO] Receiver Initialized");
 }
 
 /**
- * @brief 수신 루프 함수로, 도착한 CAN 메시지를 확인하고 Mini-MAC 태그를
- * 검증합니다.
+ * @brief 모아 둔 보호 대상 프레임을 한꺼번에 검증하고 결과를 출력합니다.
+ * @param batch 링 버퍼의 프레임을 가리키는 검증 목록
+ * @param n     프레임 수 (0이면 아무것도 하지 않음)
  *
- * 주기적으로 새로운 CAN 메시지의 도착 여부를 확인합니다. 대기 중 메시지가
- * 없으면 함수를 빠져나와 다음 주기를 준비합니다. 메시지가 수신되면 ID와 데이터
- * 길이를 읽은 후, 해당 ID가 보호 대상(PROTECTED_ID)인지 및 데이터 길이가 태그
- * 길이 이상인지 검사합니다. 보호 대상 ID가 아니거나 길이가 짧으면 해당 메시지를
- * 무시합니다. 올바른 메시지인 경우 데이터 버퍼를 페이로드와 태그로 분리합니다.
- * 분리한 페이로드와 수신 태그를 HEX 형식으로 시리얼 모니터에 출력하여 디버깅
- * 정보를 제공합니다. 마지막으로 minimac_verify 함수를 호출하여 태그의 유효성을
- * 검사하고, 인증이 성공하면 "[INFO] Auth OK", 실패하면 "[ERROR] Auth FAIL"을
- * 출력합니다.
+ * minimac_verify_batch로 수신 순서대로 검증하므로 EEPROM 저장 요청은 바뀐
+ * 컨텍스트마다 한 번뿐입니다. 인증이 성공한 프레임마다 "[INFO] Auth OK",
+ * 실패한 프레임마다 "[ERROR] Auth FAIL"을 출력합니다.
  */
-void loop() {
-  // 메시지 도착 체크
-  if (CAN.checkReceive() != CAN_MSGAVAIL) {
-    delay(10);
+void verifyBatch(const MiniMacFrame *batch, uint8_t n) {
+  if (n == 0)
     return;
-  }
 
-  // 메시지 읽기
-  unsigned long rxId;
-  uint8_t len;
-  uint8_t buf[MINIMAC_MAX_DATA + MINIMAC_TAG_LEN];
-  CAN.readMsgBuf(&rxId, &len, buf);
+  bool ok[RX_RING_SIZE];
+  MM_DEBUGLN("[DBG] minimac_verify_batch()");
+  minimac_verify_batch(batch, n, ok);
+  for (uint8_t i = 0; i < n; i++) {
+    if (ok[i]) {
+      MM_INFOLN("[INFO] Auth OK");
+    } else {
+      MM_ERRORLN("[ERROR] Auth FAIL");
+    }
+  }
+}
 
-  Serial.print("[DBG] CAN received ID=0x");
-  Serial.print(rxId, HEX);
-  Serial.print(" len=");
-  Serial.println(len);
+/**
+ * @brief 수신 루프 함수로, 링 버퍼에 쌓인 CAN 메시지의 Mini-MAC 태그를
+ * 검증합니다.
+ *
+ * 링 버퍼가 비어 있으면 바로 빠져나옵니다(대기 없음). 쌓인 프레임마다 ID와
+ * 데이터 길이를 출력한 뒤, 재동기화 프레임(MINIMAC_RESYNC_ID)이면 앞서 모은
+ * 프레임을 먼저 검증하고 minimac_resync로 해당 ID의 카운터를 송신 노드에
+ * 맞추고 히스토리를 비웁니다. 그 밖의 메시지는 ProtectedIds::find()로 보호
+ * 대상 ID인지 분류하고 데이터 길이가 태그 길이 이상인지 검사합니다. 보호
+ * 대상이 아니거나 길이가 짧으면 해당 메시지를 무시합니다. TRACE 로그
+ * 레벨에서는 페이로드와 수신 태그를 HEX 형식으로 출력합니다. 올바른 메시지는
+ * 링 버퍼에서 복사하지 않고 검증 목록에 모았다가 verifyBatch로 한꺼번에
+ * 검증합니다. 검증이 끝난 뒤에야 링 버퍼 자리를 ISR에 돌려줍니다. 링이 넘쳐
+ * 버린 프레임이 있으면 그 수를 "[ERROR] RX overflow"로 출력합니다.
+ */
+void loop() {
+  // 링 버퍼에 쌓인 프레임 수 (이후 도착분은 다음 loop에서 처리)
+  uint8_t tail = rxTail;
+  uint8_t n = rxHead - tail;
 
-  // ID 검증
-  if (rxId != PROTECTED_ID) {
-    Serial.println("[DBG] Ignored (unprotected ID)");
-    return;
+  if (rxDropped) {
+    noInterrupts();
+    uint16_t dropped = rxDropped;
+    rxDropped = 0;
+    interrupts();
+    MM_ERROR("[ERROR] RX overflow, dropped ");
+    MM_ERRORLN(dropped);
   }
-  if (len < MINIMAC_TAG_LEN) {
-    Serial.println("[ERROR] Frame too short");
+  if (n == 0)
     return;
-  }
 
-  // 페이로드/태그 분리
-  uint8_t payloadLen = len - MINIMAC_TAG_LEN;
-  uint8_t payload[MINIMAC_MAX_DATA];
-  uint8_t tag[MINIMAC_TAG_LEN];
-  memcpy(payload, buf, payloadLen);
-  memcpy(tag, buf + payloadLen, MINIMAC_TAG_LEN);
-
-  // 디버그: payload
-  Serial.print("[DBG] payload = ");
-  for (uint8_t i = 0; i < payloadLen; i++) {
-    if (payload[i] < 0x10)
-      Serial.print('0');
-    Serial.print(payload[i], HEX);
-    Serial.print(' ');
-  }
-  Serial.println();
-
-  // 디버그: recv tag
-  Serial.print("[DBG] recv tag = ");
-  for (uint8_t i = 0; i < MINIMAC_TAG_LEN; i++) {
-    if (tag[i] < 0x10)
-      Serial.print('0');
-    Serial.print(tag[i], HEX);
-    Serial.print(' ');
-  }
-  Serial.println();
-
-  // 검증
-  Serial.println("[DBG] minimac_verify()");
-  if (minimac_verify(payload, payloadLen, tag)) {
-    Serial.println("[INFO] Auth OK");
-  } else {
-    Serial.println("[ERROR] Auth FAIL");
+  MiniMacFrame batch[RX_RING_SIZE];
+  uint8_t cnt = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    const RxFrame *f = &rxRing[(uint8_t)(tail + i) & (RX_RING_SIZE - 1)];
+
+    MM_DEBUG("[DBG] CAN received ID=0x");
+    MM_DEBUG(f->id, HEX);
+    MM_DEBUG(" len=");
+    MM_DEBUGLN(f->len);
+
+    // 재동기화 프레임: 앞선 프레임을 먼저 검증한 뒤 카운터·히스토리를 맞춤
+    if (f->id == MINIMAC_RESYNC_ID) {
+      verifyBatch(batch, cnt);
+      cnt = 0;
+      if (minimac_resync(f->data, f->len)) {
+        MM_INFOLN("[INFO] Resync OK");
+      } else {
+        MM_ERRORLN("[ERROR] Resync FAIL");
+      }
+      continue;
+    }
+
+    // ID 검증: 플래시 완전 해시로 분류 (확장 ID는 bit 31이 켜져 불일치)
+    int16_t idx = ProtectedIds::find(f->id);
+    if (idx < 0) {
+      MM_DEBUGLN("[DBG] Ignored (unprotected ID)");
+      continue;
+    }
+    if (f->len < ProtectedIds::tag_len(idx)) {
+      MM_ERRORLN("[ERROR] Frame too short");
+      continue;
+    }
+
+    // 디버그: payload, recv tag
+    uint8_t payloadLen = f->len - ProtectedIds::tag_len(idx);
+    MM_TRACE("[DBG] payload = ");
+    MM_TRACE_HEX(f->data, payloadLen);
+    MM_TRACE("[DBG] recv tag = ");
+    MM_TRACE_HEX(f->data + payloadLen, ProtectedIds::tag_len(idx));
+
+    batch[cnt].can_id = (uint16_t)f->id;
+    batch[cnt].len = f->len;
+    batch[cnt].data = f->data;
+    cnt++;
   }
+  verifyBatch(batch, cnt);
+
+  // 검증이 끝난 자리를 ISR에 돌려줌
+  rxTail = tail + n;
 }
@@ -1,390 +1,743 @@
 /**
  * @file minimac.cpp
  * @brief Mini-MAC 프로토콜 구현 (EEPROM 상태 관리, HMAC-MD5 기반 MAC 생성/검증)
+ *
+ * 서명/검증과 EEPROM 저널은 MiniMac 엔진 템플릿(minimac_engine.h)에, MAC
+ * 알고리즘은 백엔드(minimac_mac.h)에 있다. 이 파일은 엔진이 함께 쓰는 CRC
+ * 도우미와 MINIMAC_* 기본 설정 엔진으로 만든 CAN ID 컨텍스트 테이블, C 함수
+ * API를 구현한다. 컨텍스트마다 MAC 알고리즘, λ, 태그 길이를 고를 수 있다.
  */
 
 #include "minimac.h"
+#include "minimac_engine.h"
+
+/// 기본 설정(minimac.h의 MINIMAC_* 매크로)의 엔진: 태그 길이와 λ는 상한이고
+/// MAC, 실제 태그 길이와 λ는 컨텍스트별로 고른다
+typedef MiniMac<MINIMAC_KEY_LEN, MINIMAC_TAG_MAX, MINIMAC_HIST_MAX,
+                MINIMAC_MAX_DATA, MiniMacAnyMac, MINIMAC_HIST_BYTES>
+    MiniMacDefault;
+
+/**
+ * @struct MiniMacCtx
+ * @brief 보호 대상 CAN ID 하나의 Mini-MAC 상태 (기본 설정 엔진)
+ *
+ * minimac_add()가 mm_ctx 테이블에서 할당하며 호출자는 포인터로만 다룬다.
+ */
+struct MiniMacCtx : MiniMacDefault {};
+
+/**
+ * @brief n개 이상의 두 배를 담는 2의 거듭제곱 (해시 테이블 크기)
+ */
+static constexpr uint16_t ctx_buckets(uint16_t n, uint16_t b = 1)
+{
+    return b >= 2 * n ? b : ctx_buckets(n, b * 2);
+}
 
-/// EEPROM 레이아웃: 시그니처 및 데이터 저장 시작 주소
-static const int    SIG_ADDR   = 0;
-static const uint32_t SIGVAL   = 0xAA55AA55;
-static const int    DATA_ADDR  = SIG_ADDR + sizeof(SIGVAL);
+/// CAN ID → 컨텍스트 해시 테이블 크기 (적재율 ≤ 1/2, 2의 거듭제곱)
+static const uint16_t CTX_BUCKETS = ctx_buckets(MINIMAC_MAX_CTX);
 
-/// 보호할 CAN ID, 그룹 키, 카운터, 메시지 히스토리
-static uint16_t    mm_id;                        ///< CAN ID (그룹 식별자)
-static uint8_t     mm_key[MINIMAC_KEY_LEN];      ///< 공유 그룹 키
-static uint64_t    mm_counter;                   ///< 64비트 메시지 카운터
-static MiniMacHist mm_hist[MINIMAC_HIST_LEN];    ///< 최근 λ개 메시지 히스토리
-static uint8_t     mm_hist_cnt;                  ///< 히스토리 항목 수 (≤ λ)
+static_assert(MINIMAC_MAX_CTX >= 1 && MINIMAC_MAX_CTX <= 0x4000,
+              "MINIMAC_MAX_CTX must be in 1..16384");
+static_assert(MINIMAC_HIST_LEN >= 1 && MINIMAC_HIST_LEN <= MINIMAC_HIST_MAX,
+              "MINIMAC_HIST_LEN must be in 1..MINIMAC_HIST_MAX");
+static_assert(MINIMAC_TAG_LEN >= 1 && MINIMAC_TAG_LEN <= MINIMAC_TAG_MAX,
+              "MINIMAC_TAG_LEN must be in 1..MINIMAC_TAG_MAX");
+
+/// 컨텍스트 테이블과 CAN ID 해시 인덱스 (등록 순서 = EEPROM 영역 번호)
+static MiniMacCtx  mm_ctx[MINIMAC_MAX_CTX];    ///< 컨텍스트 저장소
+static uint16_t    mm_ctx_cnt;                   ///< 등록된 컨텍스트 수
+static uint16_t    mm_ctx_index[CTX_BUCKETS];    ///< 컨텍스트 번호 + 1 (0 = 빈 칸)
+static MiniMacCtx *mm_default;                   ///< 단일 ID API용 컨텍스트
 
 /**
- * @brief 디버깅용: 바이트 배열을 16진수로 출력
- * @param buf   출력할 바이트 배열
- * @param len   배열 길이(Byte)
+ * @brief CRC-16/CCITT(다항식 0x1021) 누적 계산
+ * @param crc   이전 CRC 값 (시작값 0xFFFF)
+ * @param data  입력 바이트
+ * @param len   입력 길이(Byte)
+ * @return 갱신된 CRC 값
  */
-static void debug_print_hex(const uint8_t *buf, uint16_t len)
+uint16_t minimac_crc16_update(uint16_t crc, const void *data, uint16_t len)
 {
+    const uint8_t *p = (const uint8_t *)data;
     for (uint16_t i = 0; i < len; i++) {
-        if (buf[i] < 0x10) Serial.print('0');
-        Serial.print(buf[i], HEX);
-        Serial.print(' ');
+        crc ^= (uint16_t)p[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
     }
-    Serial.println();
+    return crc;
 }
 
 /**
- * @brief 디버깅용: 64비트 부호 없는 정수를 10진수 문자열로 변환해 출력
- * @param v     변환할 64비트 값
+ * @brief 로그용 Serial 포트 초기화 (최초 1회)
  */
-static void print_u64(uint64_t v)
+void minimac_log_begin(void)
 {
-    if (v == 0) {
-        Serial.print('0');
+#if MINIMAC_LOG_LEVEL > MINIMAC_LOG_OFF
+    static bool started;
+    if (started)
         return;
-    }
-    char buf[21];      // 최대 20자리 숫자 + 널 종료
-    buf[20] = '\0';
-    int pos = 19;
-    while (v > 0 && pos >= 0) {
-        buf[pos--] = '0' + (v % 10);
-        v /= 10;
-    }
-    Serial.print(&buf[pos + 1]);
+    started = true;
+
+    /* Serial 초기화: 로그 출력용 */
+    Serial.begin(115200);
+    while (!Serial)
+        /* 시리얼 포트가 준비될 때까지 대기 */;
+#endif
 }
 
 /**
- * @brief Mini-MAC용 HMAC-MD5 다이제스트 계산
- * @param data    서명할 페이로드 데이터 버퍼
- * @param len     페이로드 길이(Byte)
- * @param digest  결과 다이제스트 저장 버퍼(16바이트)
+ * @brief CAN ID의 해시 인덱스 시작 버킷
  *
- * 메시지 카운터(mm_counter), CAN ID(mm_id), 최근 메시지 히스토리(mm_hist),
- * 그리고 현재 페이로드(data)를 하나의 연속 버퍼에 결합한 후,
- * HMAC-MD5를 수행하여 16바이트 다이제스트를 생성한다.
- * 각 단계별 내부 상태는 Serial 디버그 출력으로 확인 가능하다.
- */
-static void compute_digest(const uint8_t *data, uint8_t len, unsigned char digest[16])
-{
-    /* (1) 버퍼 크기 계산:
-     *     - 메시지 카운터(mm_counter, 8바이트)
-     *     - CAN ID(mm_id, 2바이트)
-     *     - 과거 메시지 히스토리(mm_hist_cnt개, 각 항목 len 바이트)
-     *     - 현재 페이로드(data, len 바이트)
-     *   위 항목의 총합(buf_len)을 계산한 뒤, 이를 저장할 버퍼(buf)를 동적 할당.
-     *   off 변수는 buf 내 현재 쓰기 위치를 나타냄.
-     */
-    uint16_t buf_len = 8 + 2;
-    for (uint8_t i = 0; i < mm_hist_cnt; i++)
-        buf_len += mm_hist[i].len;
-    buf_len += len;
-
-    uint8_t *buf = (uint8_t *)malloc(buf_len);
-    uint16_t off = 0;
-
-    /* (2) 카운터 삽입 (big-endian):
-     *   - 64비트 카운터를 빅엔디안 순서로 buf[off..off+7]에 저장
-     *   - Serial.print로 현재 카운터 값을 10진수 문자열로 출력
-     */
-    Serial.print("[DBG] counter = ");
-    print_u64(mm_counter);
-    Serial.println();
-
-    uint64_t tmp = mm_counter;
-    for (int i = 7; i >= 0; i--) {
-        buf[off + i] = tmp & 0xFF;
-        tmp >>= 8;
-    }
-    off += 8;
-
-    /* (3) CAN ID 삽입:
-     *   - mm_id 상위 바이트(buf[off])와 하위 바이트(buf[off+1])를 저장
-     *   - Serial.print로 16진수 형태의 CAN ID 출력
-     */
-    buf[off++] = mm_id >> 8;
-    buf[off++] = mm_id & 0xFF;
-    Serial.print("[DBG] CAN ID = 0x");
-    Serial.println(mm_id, HEX);
-
-    /* (4) 메시지 히스토리 삽입:
-     *   - 저장된 히스토리 개수(mm_hist_cnt)만큼 반복
-     *   - 각 항목(mm_hist[i].data, length mm_hist[i].len)을 buf에 복사
-     *   - debug_print_hex로 각 히스토리 데이터 덤프
-     */
-    Serial.print("[DBG] history_count = ");
-    Serial.println(mm_hist_cnt);
-
-    for (uint8_t i = 0; i < mm_hist_cnt; i++) {
-        Serial.print("[DBG] hist[");
-        Serial.print(i);
-        Serial.print("] = ");
-        debug_print_hex(mm_hist[i].data, mm_hist[i].len);
-
-        memcpy(buf + off, mm_hist[i].data, mm_hist[i].len);
-        off += mm_hist[i].len;
-    }
-
-    /* (5) 현재 페이로드 삽입:
-     *   - data[0..len-1]를 buf에 연속 복사
-     *   - debug_print_hex로 페이로드 덤프
-     */
-    Serial.print("[DBG] current_data = ");
-    debug_print_hex(data, len);
-
-    memcpy(buf + off, data, len);
-    off += len;
-
-    /* (6) HMAC-MD5 계산:
-     *   - MD5.hmac_md5(buf, off, mm_key, MINIMAC_KEY_LEN, digest)를 호출하여
-     *     전체 입력(buf, 길이 off)에 대한 HMAC-MD5 다이제스트 생성
-     *   - debug_print_hex로 16바이트 raw MD5 덤프
-     *   - 동적 할당된 buf 메모리 해제
-     */
-    MD5 hasher;
-    hasher.hmac_md5(buf, off, (void *)mm_key, MINIMAC_KEY_LEN, digest);
-
-    Serial.print("[DBG] raw MD5 = ");
-    debug_print_hex(digest, 16);
-
-    free(buf);
+ * 곱셈 해시(16비트 황금비 상수)의 상위 비트를 버킷 범위로 줄인다. 연속된
+ * CAN ID도 버킷 전체에 고르게 흩어진다.
+ */
+static uint16_t ctx_hash(uint16_t id)
+{
+    uint16_t h = (uint16_t)(id * 40503u);
+    return (uint16_t)(((uint32_t)h * CTX_BUCKETS) >> 16);
 }
 
 /**
- * @brief EEPROM에서 Mini-MAC 상태 불러오기
+ * @brief 보호할 CAN ID를 MAC 알고리즘, λ, 태그 길이를 지정해 등록 및 EEPROM
+ *        상태 동기화
+ * @param can_id  보호할 CAN 메시지 식별자 (16비트)
+ * @param key     이 ID의 Mini-MAC 키 (128비트, 16바이트)
+ * @param mac     이 ID의 MAC 알고리즘
+ * @param lambda  이 ID의 메시지 히스토리 길이 λ (1..MINIMAC_HIST_MAX)
+ * @param tag_len 이 ID의 태그 길이(Byte, 1..MINIMAC_TAG_MAX)
+ * @return 등록된 컨텍스트, 테이블이 가득 찼거나 키 길이가 알고리즘에 맞지
+ *         않거나 λ/태그 길이가 범위를 벗어나면 NULL
  *
- * EEPROM에 저장된 시그니처(SIGVAL)를 확인한 뒤,
- * 유효하면 mm_counter, mm_hist_cnt 및 메시지 히스토리 배열을 복원한다.
+ * 컨텍스트 테이블(mm_ctx)에서 다음 칸을 할당해 CAN ID 해시 인덱스에 넣고
+ * MAC 알고리즘을 고른 뒤 이 ID의 λ와 태그 길이로 엔진을 시작한다
+ * (MiniMac::begin). 엔진의 버퍼와 EEPROM 슬롯은 상한(MINIMAC_HIST_MAX,
+ * MINIMAC_TAG_MAX) 크기이므로 어느 값이든 같은 칸에 담긴다. 이미 등록된 ID면
+ * 새 칸을 만들지 않고 그 컨텍스트를 EEPROM에서 다시 초기화한다.
  *
- * @return true  EEPROM에 유효한 상태가 있어 복원 성공  
- * @return false 시그니처 불일치로 초기화가 필요함  
+ * 컨텍스트 테이블은 EEPROM 앞쪽 MINIMAC_EE_SIZE바이트(0이면 전체)를
+ * MINIMAC_MAX_CTX개 영역으로 똑같이 나누고 등록 순서대로 영역을 배정한다.
+ * 영역이 저널 슬롯 두 개도 담지 못하면 상태를 저장하지 않는다(재부팅 시
+ * 카운터 0부터 시작).
  */
-static bool load_state(void)
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key, MiniMacAlg mac,
+                        uint8_t lambda, uint8_t tag_len)
 {
-    uint32_t sig;
-
-    /* (1) 시그니처 확인 */
-    EEPROM.get(SIG_ADDR, sig);
-    if (sig != SIGVAL)
-        return false;
-
-    /* (2) 카운터 및 히스토리 개수 복원 */
-    EEPROM.get(DATA_ADDR,                     mm_counter);
-    EEPROM.get(DATA_ADDR + sizeof(mm_counter), mm_hist_cnt);
-
-    /* (3) 히스토리 항목 복원 */
-    int addr = DATA_ADDR + sizeof(mm_counter)
-                      + sizeof(mm_hist_cnt);
-    for (uint8_t i = 0; i < mm_hist_cnt; i++) {
-        /* (3a) 각 히스토리 길이 로드 */
-        EEPROM.get(addr, mm_hist[i].len);
-        addr += sizeof(mm_hist[i].len);
-
-        /* (3b) 고정 크기 버퍼에 과거 페이로드 데이터 로드 */
-        EEPROM.get(addr, mm_hist[i].data);
-        addr += MINIMAC_MAX_DATA;
+    minimac_log_begin();
+    MM_DEBUG("[DBG] minimac_add(0x");
+    MM_DEBUG(can_id, HEX);
+    MM_DEBUGLN(")");
+
+    if (mac != MINIMAC_MAC_HMAC_MD5 && MINIMAC_KEY_LEN != 16) {
+        MM_ERRORLN("[ERROR] minimac_add: MAC needs a 16-byte key");
+        return NULL;
+    }
+    if (lambda < 1 || lambda > MINIMAC_HIST_MAX || tag_len < 1 ||
+          tag_len > MINIMAC_TAG_MAX) {
+          MM_ERRORLN("[ERROR] minimac_add: lambda/tag length out of range");
+        return NULL;
     }
 
-    /* (4) 디버그 출력으로 복원된 상태 확인 */
-    Serial.println("[DBG] load_state: loaded from EEPROM");
-    Serial.print("  counter = ");
-    print_u64(mm_counter);
-    Serial.println();
-    Serial.print("  history_count = ");
-    Serial.println(mm_hist_cnt);
+    /* (1) 컨텍스트 할당: 이미 등록된 ID는 재사용, 새 ID는 해시 인덱스에 추가 */
+    MiniMacCtx *c = minimac_find(can_id);
+    if (!c) {
+        if (mm_ctx_cnt == MINIMAC_MAX_CTX) {
+            MM_ERRORLN("[ERROR] minimac_add: context table full");
+            return NULL;
+        }
+        c = &mm_ctx[mm_ctx_cnt++];
+
+        uint16_t b = ctx_hash(can_id);
+        while (mm_ctx_index[b])
+            b = (b + 1) & (CTX_BUCKETS - 1);
+        mm_ctx_index[b] = mm_ctx_cnt;
+    }
 
-    return true;
+    /* (2) MAC 선택 후 등록 순서에 해당하는 EEPROM 영역으로 엔진 시작 */
+    int region = (MINIMAC_EE_SIZE ? MINIMAC_EE_SIZE : EEPROM.length()) /
+                 MINIMAC_MAX_CTX;
+    c->backend().select(mac);
+    c->begin(can_id, key, (int)(c - mm_ctx) * region, region, lambda, tag_len);
+    return c;
 }
 
 /**
- * @brief Mini-MAC 상태를 EEPROM에 저장
- *
- * 현재 mm_counter, mm_hist_cnt 및 메시지 히스토리 배열을
- * EEPROM에 시그니처와 함께 순차 기록하여 재부팅 시에도 상태 유지.
+ * @brief 보호할 CAN ID를 기본 λ와 태그 길이(MINIMAC_HIST_LEN/TAG_LEN)로 등록
  */
-static void save_state(void)
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key, MiniMacAlg mac)
 {
-    /* (1) 시그니처 기록 */
-    EEPROM.put(SIG_ADDR, SIGVAL);
-
-    /* (2) 카운터 및 히스토리 개수 기록 */
-    EEPROM.put(DATA_ADDR,                       mm_counter);
-    EEPROM.put(DATA_ADDR + sizeof(mm_counter),  mm_hist_cnt);
+    return minimac_add(can_id, key, mac, MINIMAC_HIST_LEN, MINIMAC_TAG_LEN);
+}
 
-    /* (3) 히스토리 항목 기록 */
-    int addr = DATA_ADDR + sizeof(mm_counter)
-                      + sizeof(mm_hist_cnt);
-    for (uint8_t i = 0; i < mm_hist_cnt; i++) {
-        /* (3a) 각 히스토리 길이 저장 */
-        EEPROM.put(addr, mm_hist[i].len);
-        addr += sizeof(mm_hist[i].len);
+/**
+ * @brief 보호할 CAN ID를 HMAC-MD5로 등록 (기존 노드와 태그 호환)
+ */
+MiniMacCtx *minimac_add(uint16_t can_id, const uint8_t *key)
+{
+    return minimac_add(can_id, key, MINIMAC_MAC_HMAC_MD5);
+}
 
-        /* (3b) 고정 크기 버퍼에 과거 페이로드 데이터 저장 */
-        EEPROM.put(addr, mm_hist[i].data);
-        addr += MINIMAC_MAX_DATA;
+/**
+ * @brief CAN ID로 등록된 컨텍스트 찾기
+ * @param can_id 수신/송신 프레임의 CAN ID
+ * @return 등록된 컨텍스트, 보호 대상이 아니면 NULL
+ *
+ * 해시 인덱스를 선형 탐사한다. 적재율이 1/2 이하라서 빈 버킷을 곧 만나므로
+ * 등록된 ID 수와 무관하게 평균 상수 시간이다.
+ */
+MiniMacCtx *minimac_find(uint16_t can_id)
+{
+    uint16_t b = ctx_hash(can_id);
+    while (mm_ctx_index[b]) {
+        MiniMacCtx *c = &mm_ctx[mm_ctx_index[b] - 1];
+        if (c->can_id() == can_id)
+            return c;
+        b = (b + 1) & (CTX_BUCKETS - 1);
     }
+    return NULL;
+}
 
-    /* (4) 디버그 출력으로 저장된 상태 확인 */
-    Serial.println("[DBG] save_state: saved to EEPROM");
-    Serial.print("  counter = ");
-    print_u64(mm_counter);
-    Serial.println();
-    Serial.print("  history_count = ");
-    Serial.println(mm_hist_cnt);
+/**
+ * @brief 등록 순서 번호로 컨텍스트 찾기
+ * @param index minimac_add() 호출 순서 (0부터)
+ * @return 컨텍스트, 아직 등록되지 않은 번호면 NULL
+ *
+ * ID 목록이 컴파일 시 정해진 경우(minimac_idset.h) 분류 결과를 해시 탐색
+ * 없이 바로 컨텍스트로 바꾼다.
+ */
+MiniMacCtx *minimac_ctx_at(uint16_t index)
+{
+    return index < mm_ctx_cnt ? &mm_ctx[index] : NULL;
 }
 
 /**
- * @brief Mini-MAC 초기화 및 EEPROM 동기화
+ * @brief 단일 ID용 초기화 (minimac_add()로 등록하고 기본 컨텍스트로 지정)
  * @param can_id 보호할 CAN 메시지 식별자 (16비트)
  * @param key    Mini-MAC HMAC 키 (128비트, 16바이트)
- *
- * Serial 포트를 115200bps로 초기화하고, mm_id와 mm_key 전역 변수에
- * 인자를 설정한다. EEPROM에서 이전에 저장된 mm_counter와 메시지
- * 히스토리를 불러오되(load_state()), 저장된 시그니처가 없으면
- * fresh 상태로 간주하여 mm_counter와 mm_hist_cnt를 0으로 초기화한
- * 뒤(save_state()), EEPROM에 초기 상태를 기록한다.
- * 디버그용으로 Serial.print를 통해 초기화 과정을 출력한다.
  */
 void minimac_init(uint16_t can_id, const uint8_t *key)
 {
-    /* Serial 초기화: 디버그 출력용 */
-    Serial.begin(115200);
-    while (!Serial)
-        /* 시리얼 포트가 준비될 때까지 대기 */;
-    Serial.println("[DBG] minimac_init()");
+    MM_DEBUGLN("[DBG] minimac_init()");
+    mm_default = minimac_add(can_id, key);
+}
 
-    /* (1) CAN ID 설정: 보호할 그룹 식별자 */
-    mm_id = can_id;
+/**
+ * @brief 컨텍스트의 저장된 상태를 버리고 fresh 상태(카운터 0, 히스토리
+ *        없음)로 시작
+ * @param ctx 대상 컨텍스트
+ *
+ * EEPROM 전체를 지우는 대신 초기 상태 레코드 하나를 그 컨텍스트의 저널에
+ * 추가한다(MiniMac::reset). 기록은 쓰기 큐로 넘어가므로 바로 반환한다.
+ */
+void minimac_reset(MiniMacCtx *ctx)
+{
+    MM_DEBUGLN("[DBG] minimac_reset()");
+    ctx->reset();
+}
 
-    /* (2) 그룹 키 복사: 16바이트 비밀키 */
-    memcpy(mm_key, key, MINIMAC_KEY_LEN);
+/**
+ * @brief 기본 컨텍스트(minimac_init())의 상태를 fresh 상태로 되돌림
+ */
+void minimac_reset(void)
+{
+    minimac_reset(mm_default);
+}
 
-    /* (3) EEPROM에서 이전 상태 불러오기 */
-    if (!load_state()) {
-        /* EEPROM에 유효한 시그니처 없음: fresh 초기화 */
-        Serial.println("[DBG] minimac_init: no EEPROM state, initialize fresh");
+/**
+ * @brief 송신할 메시지에 Mini-MAC 태그 생성 및 내부 상태 갱신
+ * @param ctx         송신 CAN ID의 컨텍스트
+ * @param data        서명할 페이로드 버퍼, 호출 후 buf[payload_len..] 위치에 태그가 덧붙여짐
+ * @param payload_len 페이로드 길이(Byte)
+ * @return 전체 전송 길이 (payload_len + 컨텍스트의 태그 길이)
+ *
+ * 기본 설정 엔진의 MiniMac::sign()을 호출한다.
+ */
+uint8_t minimac_sign(MiniMacCtx *ctx, uint8_t *data, uint8_t payload_len)
+{
+    return ctx->sign(data, payload_len);
+}
 
-        /* (3a) 카운터 초기화 */
-        mm_counter   = 0;
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 태그 생성
+ */
+uint8_t minimac_sign(uint8_t *data, uint8_t payload_len)
+{
+    return minimac_sign(mm_default, data, payload_len);
+}
 
-        /* (3b) 히스토리 개수 초기화 */
-        mm_hist_cnt  = 0;
+/**
+ * @brief 2단계 서명 준비 (상태 변경 없음)
+ * @param ctx         송신 CAN ID의 컨텍스트
+ * @param data        서명할 페이로드 버퍼, 뒤에 태그가 덧붙여짐
+ * @param payload_len 페이로드 길이(Byte)
+ * @return 전체 전송 길이 (payload_len + 컨텍스트의 태그 길이)
+ *
+ * 기본 설정 엔진의 MiniMac::sign_prepare()를 호출한다.
+ */
+uint8_t minimac_sign_prepare(MiniMacCtx *ctx, uint8_t *data,
+                             uint8_t payload_len)
+{
+    MM_DEBUGLN("[DBG] minimac_sign_prepare()");
+    return ctx->sign_prepare(data, payload_len);
+}
 
-        /* (3c) 초기 상태 EEPROM에 저장 */
-        save_state();
-    }
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 준비
+ */
+uint8_t minimac_sign_prepare(uint8_t *data, uint8_t payload_len)
+{
+    return minimac_sign_prepare(mm_default, data, payload_len);
 }
 
 /**
- * @brief 송신할 메시지에 Mini-MAC 태그 생성 및 내부 상태 갱신
- * @param data        서명할 페이로드 버퍼, 호출 후 buf[payload_len..] 위치에 태그가 덧붙여짐
+ * @brief 2단계 서명 확정 (전송 성공 후 상태 갱신)
+ * @param ctx         송신 CAN ID의 컨텍스트
+ * @param data        준비 때와 같은 페이로드
  * @param payload_len 페이로드 길이(Byte)
- * @return 전체 전송 길이 (payload_len + MINIMAC_TAG_LEN)
+ * @return true  상태 갱신, false 준비된 서명 없음
  *
- * 전달받은 페이로드(data, payload_len)를 바탕으로 HMAC-MD5 다이제스트를 계산하여
- * 상위 4바이트(tag)를 data 뒤에 덧붙인다. 이후 메시지 히스토리(mm_hist)와
- * 메시지 카운터(mm_counter)를 갱신하고 EEPROM에 저장(save_state)한다.
+ * 기본 설정 엔진의 MiniMac::sign_commit()을 호출한다.
  */
-uint8_t minimac_sign(uint8_t *data, uint8_t payload_len)
+bool minimac_sign_commit(MiniMacCtx *ctx, const uint8_t *data,
+                         uint8_t payload_len)
 {
-    /* 디버그: 함수 진입 */
-    Serial.println("[DBG] minimac_sign()");
+    return ctx->sign_commit(data, payload_len);
+}
 
-    /* (1) HMAC 입력 구성 및 다이제스트 계산 */
-    unsigned char digest[16];
-    compute_digest(data, payload_len, digest);
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 확정
+ */
+bool minimac_sign_commit(const uint8_t *data, uint8_t payload_len)
+{
+    return minimac_sign_commit(mm_default, data, payload_len);
+}
 
-    /* (2) 디버그: 생성된 다이제스트의 태그 부분 출력 */
-    Serial.print("[DBG] sign: tag = ");
-    debug_print_hex(digest, MINIMAC_TAG_LEN);
+/**
+ * @brief 2단계 서명 취소 (전송 실패)
+ * @param ctx 송신 CAN ID의 컨텍스트
+ */
+void minimac_sign_abort(MiniMacCtx *ctx)
+{
+    ctx->sign_abort();
+}
 
-    /* (3) 태그(4바이트) 붙이기 */
-    memcpy(data + payload_len, digest, MINIMAC_TAG_LEN);
-    uint8_t total = payload_len + MINIMAC_TAG_LEN;
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 2단계 서명 취소
+ */
+void minimac_sign_abort(void)
+{
+    minimac_sign_abort(mm_default);
+}
 
-    /* (4) 메시지 히스토리 순환 버퍼 관리 */
-    if (mm_hist_cnt == MINIMAC_HIST_LEN) {
-        Serial.println("[DBG] sign: history full, dropping oldest");
-        /* 가장 오래된 히스토리 항목 삭제 */
-        for (uint8_t i = 1; i < mm_hist_cnt; i++)
-            mm_hist[i - 1] = mm_hist[i];
-        mm_hist_cnt--;
-    }
-    /* 새로운 페이로드를 히스토리에 추가 */
-    mm_hist[mm_hist_cnt].len = payload_len;
-    memcpy(mm_hist[mm_hist_cnt].data, data, payload_len);
-    mm_hist_cnt++;
-    Serial.print("[DBG] sign: new history_count = ");
-    Serial.println(mm_hist_cnt);
+/**
+ * @brief 가장 먼저 준비한 프레임의 전송 결과 알림 (ISR에서 호출 가능)
+ * @param ctx  프레임을 준비한 컨텍스트
+ * @param sent true 버스에 나감, false 버려짐
+ */
+void minimac_sign_done(MiniMacCtx *ctx, bool sent)
+{
+    ctx->sign_done(sent);
+}
 
-    /* (5) 카운터 증가 및 디버그 출력 */
-    mm_counter++;
-    Serial.print("[DBG] sign: new counter = ");
-    print_u64(mm_counter);
-    Serial.println();
+/**
+ * @brief 알린 전송 결과를 반영한 뒤 결과를 모르는 준비 프레임 수
+ * @param ctx 송신 CAN ID의 컨텍스트
+ */
+uint8_t minimac_sign_pending(MiniMacCtx *ctx)
+{
+    return ctx->pending();
+}
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())의 결과를 모르는 준비 프레임 수
+ */
+uint8_t minimac_sign_pending(void)
+{
+    return minimac_sign_pending(mm_default);
+}
+
+/**
+ * @brief 송신할 페이로드 여러 개를 순서대로 서명하고 상태는 한 번만 저장
+ * @param frames 송신 순서대로 놓인 프레임 배열
+ * @param n      프레임 수
+ * @return 서명한 프레임 수
+ *
+ * minimac_verify_batch()와 같이 프레임마다 MiniMac::sign()을 저장 없이
+ * 호출하고, 끝에서 프레임들의 컨텍스트마다 MiniMac::persist()를 부른다.
+ */
+uint8_t minimac_sign_batch(MiniMacTxFrame *frames, uint8_t n)
+{
+    MM_DEBUG("[DBG] minimac_sign_batch: n = ");
+    MM_DEBUGLN(n);
+
+    /* (1) 배열 순서대로 서명, 상태 저장은 미룸 */
+    uint8_t ok = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        MiniMacTxFrame *f = &frames[i];
+        MiniMacCtx *c = minimac_find(f->can_id);
+        if (!c || f->len > MINIMAC_MAX_DATA) {
+            MM_ERRORLN("[ERROR] minimac_sign_batch: bad frame");
+            f->len = 0;
+            continue;
+        }
+        f->len = c->sign(f->data, f->len, false);
+        if (f->len)
+            ok++;
+    }
 
-    /* (6) EEPROM에 상태 저장 */
-    save_state();
+    /* (2) 프레임들의 컨텍스트에 저장 요청 (바뀐 컨텍스트만 1회 기록) */
+    for (uint8_t i = 0; i < n; i++) {
+        MiniMacCtx *c = minimac_find(frames[i].can_id);
+        if (c)
+            c->persist();
+    }
+    return ok;
+}
 
-    return total;
+/**
+ * @brief 수신 프레임(페이로드 ‖ 태그)을 컨텍스트의 태그 길이로 제자리에서
+ *        나눠 검증
+ * @param c       수신 CAN ID의 컨텍스트 (NULL이면 실패)
+ * @param len     수신 길이 (페이로드 + 태그)
+ * @param data    수신 데이터
+ * @param persist false면 EEPROM 저장을 미룸 (MiniMac::verify())
+ */
+static bool frame_verify(MiniMacCtx *c, uint8_t len, const uint8_t *data,
+                         bool persist)
+{
+    if (!c)
+        return false;
+    uint8_t tag_len = c->tag_length();
+    if (len < tag_len || len - tag_len > MINIMAC_MAX_DATA)
+        return false;
+    uint8_t payload_len = len - tag_len;
+    return c->verify(data, payload_len, data + payload_len, persist);
 }
 
 /**
  * @brief 수신된 메시지의 Mini-MAC 태그 검증 및 상태 동기화
+ * @param ctx         수신 CAN ID의 컨텍스트 (minimac_find())
  * @param data        검증할 페이로드 버퍼
  * @param payload_len 페이로드 길이(Byte)
- * @param tag         수신된 태그 버퍼 (MINIMAC_TAG_LEN 바이트)
+ * @param tag         수신된 태그 버퍼 (컨텍스트의 태그 길이)
  * @return true  검증 성공 및 내부 상태 갱신
  * @return false 검증 실패 (TAG 불일치)
  *
- * data와 tag를 기반으로 HMAC-MD5 다이제스트를 재계산하여 수신된
- * tag와 비교한다. 검증 성공 시 메시지 히스토리(mm_hist)와
- * 카운터(mm_counter)를 갱신하고 EEPROM에 저장(save_state)한 뒤
- * true를 반환한다. 실패 시 false 반환하며 상태는 갱신되지 않음.
+ * 기본 설정 엔진의 MiniMac::verify()를 호출한다.
+ */
+bool minimac_verify(MiniMacCtx *ctx, const uint8_t *data, uint8_t payload_len,
+                    const uint8_t *tag)
+{
+    return ctx->verify(data, payload_len, tag);
+}
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 태그 검증
  */
 bool minimac_verify(const uint8_t *data, uint8_t payload_len, const uint8_t *tag)
 {
-    /* 디버그: 함수 진입 */
-    Serial.println("[DBG] minimac_verify()");
+    return minimac_verify(mm_default, data, payload_len, tag);
+}
+
+/**
+ * @brief 수신한 CAN 프레임을 그대로 넘겨 태그 검증
+ *
+ * 확장 ID(bit 31)나 원격 프레임(bit 30)은 표준 ID 범위를 벗어나므로
+ * 컨텍스트를 찾기 전에 실패한다. 나머지는 minimac_verify_batch()와 같은
+ * frame_verify()로 처리한다.
+ */
+bool minimac_verify_frame(uint32_t can_id, uint8_t len, const uint8_t *data)
+{
+    if (can_id > 0x7FF)
+        return false;
+    return frame_verify(minimac_find((uint16_t)can_id), len, data, true);
+}
+
+/**
+ * @brief 재동기화 프레임 준비 (상태 변경 없음)
+ * @param ctx 알릴 CAN ID의 컨텍스트
+ * @param buf 프레임 버퍼
+ * @return 전송 길이
+ *
+ * 기본 설정 엔진의 MiniMac::resync_prepare()를 호출한다.
+ */
+uint8_t minimac_resync_prepare(MiniMacCtx *ctx, uint8_t *buf)
+{
+    return ctx->resync_prepare(buf);
+}
 
-    /* (1) HMAC 입력 구성 및 다이제스트 재계산 */
-    unsigned char digest[16];
-    compute_digest(data, payload_len, digest);
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 재동기화 프레임 준비
+ */
+uint8_t minimac_resync_prepare(uint8_t *buf)
+{
+    return minimac_resync_prepare(mm_default, buf);
+}
 
-    /* (2) 디버그: 기대 태그(expected) 및 수신 태그(received) 출력 */
-    Serial.print("[DBG] verify: expected tag = ");
-    debug_print_hex(digest, MINIMAC_TAG_LEN);
-    Serial.print("[DBG] verify: recv    tag = ");
-    debug_print_hex(tag, MINIMAC_TAG_LEN);
+/**
+ * @brief 재동기화 프레임 전송 성공 후 상태 확정
+ * @param ctx 알린 CAN ID의 컨텍스트
+ * @return true 상태 갱신, false 준비된 재동기화 프레임 없음
+ */
+bool minimac_resync_commit(MiniMacCtx *ctx)
+{
+    return ctx->resync_commit();
+}
+
+/**
+ * @brief 기본 컨텍스트(minimac_init())로 재동기화 프레임 확정
+ */
+bool minimac_resync_commit(void)
+{
+    return minimac_resync_commit(mm_default);
+}
 
-    /* (3) 태그 비교: 불일치 시 실패 처리 */
-    if (memcmp(digest, tag, MINIMAC_TAG_LEN) != 0) {
-        Serial.println("[DBG] verify: FAILED");
+/**
+ * @brief 수신한 재동기화 프레임 검증 및 상태 빨리 감기
+ * @param data 수신 데이터
+ * @param len  수신 길이(DLC)
+ * @return true 검증 성공, false 보호 대상 아님·길이 오류·태그 불일치
+ *
+ * 페이로드 앞 11비트의 CAN ID로 컨텍스트를 찾아 MiniMac::resync()를
+ * 호출한다.
+ */
+bool minimac_resync(const uint8_t *data, uint8_t len)
+{
+    if (len < MiniMacDefault::RESYNC_LEN)
         return false;
+    MiniMacCtx *c = minimac_find(MiniMacDefault::resync_id(data));
+    return c && c->resync(data, len);
+}
+
+/**
+ * @brief 수신 프레임 여러 개를 순서대로 검증하고 상태는 한 번만 저장
+ * @param frames  수신 순서대로 놓인 프레임 배열
+ * @param n       프레임 수
+ * @param results 프레임별 결과 저장 위치 (NULL 허용)
+ * @return 검증에 성공한 프레임 수
+ *
+ * 프레임마다 MiniMac::verify()를 저장 없이(persist = false) 호출해 같은
+ * ID의 상태를 이어 가고, 끝에서 프레임들의 컨텍스트마다 MiniMac::persist()를
+ * 부른다. persist()는 카운터가 예약 구간을 벗어난 경우에만 기록하므로 같은
+ * 컨텍스트를 여러 번 불러도, 실패만 한 컨텍스트를 불러도 저장은 최대 한
+ * 번이다.
+ */
+uint8_t minimac_verify_batch(const MiniMacFrame *frames, uint8_t n,
+                             bool *results)
+{
+    MM_DEBUG("[DBG] minimac_verify_batch: n = ");
+    MM_DEBUGLN(n);
+
+    /* (1) 도착 순서대로 검증, 상태 저장은 미룸 */
+    uint8_t ok = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const MiniMacFrame *f = &frames[i];
+        bool r = frame_verify(minimac_find(f->can_id), f->len, f->data, false);
+        if (results)
+            results[i] = r;
+        ok += r;
+    }
+
+    /* (2) 프레임들의 컨텍스트에 저장 요청 (바뀐 컨텍스트만 1회 기록) */
+    for (uint8_t i = 0; i < n; i++) {
+        MiniMacCtx *c = minimac_find(frames[i].can_id);
+        if (c)
+            c->persist();
+    }
+    return ok;
+}
+
+/// 표준 CAN ID 비트
+static const uint16_t STD_ID_MASK = 0x7FF;
+
+/**
+ * @brief 11비트 값의 1인 비트 수
+ */
+static uint8_t filt_bits(uint16_t x)
+{
+    uint8_t n = 0;
+    for (; x; x &= x - 1)
+        n++;
+    return n;
+}
+
+/**
+ * @brief 필터 묶음 하나(마스크 하나를 공유)로 수신되는 ID 수 (상한)
+ * @param val  묶음별 대표 ID (무시 비트는 0)
+ * @param dc   묶음별 무시 비트
+ * @param set  이 버퍼에 배정한 묶음 (비트 i = 묶음 i)
+ * @param n    묶음 수
+ * @param mask 계산한 마스크 저장 위치
+ *
+ * 마스크는 배정한 묶음의 무시 비트를 모두 뺀 것이고, 서로 다른 필터 값
+ * 하나마다 2^(마스크의 0 비트 수)개 ID가 수신된다.
+ */
+static uint16_t filt_group_cost(const uint16_t *val, const uint16_t *dc,
+                                uint8_t set, uint8_t n, uint16_t *mask)
+{
+    uint16_t m = STD_ID_MASK;
+    for (uint8_t i = 0; i < n; i++)
+        if (set & (1 << i))
+            m &= ~dc[i];
+    *mask = m;
+
+    uint16_t distinct = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (!(set & (1 << i)))
+            continue;
+        bool dup = false;
+        for (uint8_t j = 0; j < i && !dup; j++)
+            dup = (set & (1 << j)) && (val[j] & m) == (val[i] & m);
+        distinct += !dup;
+    }
+    return distinct << (11 - filt_bits(m));
+}
+
+/**
+ * @brief 필터 묶음을 한 수신 버퍼의 마스크와 필터 칸에 채우기
+ * @param out   필터 칸 (cnt개)
+ * @param cnt   필터 칸 수
+ * @param val   묶음별 대표 ID
+ * @param set   이 버퍼에 배정한 묶음
+ * @param n     묶음 수
+ * @param mask  이 버퍼의 마스크
+ *
+ * 남는 칸은 첫 필터를 반복해 수신 ID를 늘리지 않는다.
+ */
+static void filt_fill(uint16_t *out, uint8_t cnt, const uint16_t *val,
+                      uint8_t set, uint8_t n, uint16_t mask)
+{
+    uint8_t k = 0;
+    for (uint8_t i = 0; i < n; i++)
+        if (set & (1 << i))
+            out[k++] = val[i] & mask;
+    for (; k < cnt; k++)
+        out[k] = out[0];
+}
+
+/**
+ * @brief 등록된 CAN ID와 재동기화 ID만 받는 MCP2515 마스크/필터 계산
+ * @param f 결과 저장 위치
+ * @return 이 설정으로 수신되는 표준 ID 수
+ *
+ * 수신할 ID 하나하나를 묶음(대표 ID, 무시 비트)으로 시작해, 묶음이 필터 수(6)
+ * 이하가 될 때까지 합쳤을 때 수신 ID가 가장 적게 느는 두 묶음을 합친다.
+ * 그다음 묶음을 RXB0(필터 2개)와 RXB1(필터 4개)에 나누는 모든 경우 중 수신
+ * ID가 가장 적은 것을 고른다. 한 버퍼에 배정한 묶음이 없으면 다른 버퍼와
+ * 같은 마스크와 필터를 써서 아무것도 더 받지 않는다.
+ *
+ * 수신 ID 수가 같은 배정 중에서는 RXB0에 묶음을 더 많이 두고, 그다음
+ * 재동기화 ID의 묶음을 RXB0에 둔다. 묶음이 2개 이하이면 모든 ID가 RXB0
+ * 필터에 걸려 RXB1은 rollover로만 채워지므로, MiniMacCan::read()가 데이터
+ * 프레임과 재동기화 프레임을 버스 순서대로 돌려준다. 묶음이 더 많으면 RXB1
+ * 필터에만 걸리는 ID의 프레임은 그 ID끼리만 순서가 지켜진다.
+ */
+uint16_t minimac_can_filter(MiniMacCanFilter *f)
+{
+    uint16_t val[MINIMAC_MAX_CTX + 1], dc[MINIMAC_MAX_CTX + 1];
+    uint16_t n = 0;
+
+    /* (1) 수신할 표준 ID 모으기 (등록된 ID + 재동기화 ID, 중복 제거) */
+    for (uint16_t i = 0; i <= mm_ctx_cnt; i++) {
+        uint16_t id = (i < mm_ctx_cnt ? mm_ctx[i].can_id() : MINIMAC_RESYNC_ID) &
+                      STD_ID_MASK;
+        bool dup = false;
+        for (uint16_t j = 0; j < n && !dup; j++)
+            dup = val[j] == id;
+        if (!dup) {
+            val[n] = id;
+            dc[n++] = 0;
+        }
     }
 
-    /* (4) 히스토리 순환 버퍼 관리 (가득 찼다면 가장 오래된 항목 삭제) */
-    if (mm_hist_cnt == MINIMAC_HIST_LEN) {
-        Serial.println("[DBG] verify: history full, dropping oldest");
-        for (uint8_t i = 1; i < mm_hist_cnt; i++)
-            mm_hist[i - 1] = mm_hist[i];
-        mm_hist_cnt--;
+    /* (2) 묶음이 6개 이하가 될 때까지 수신 ID가 가장 적게 느는 쌍 합치기 */
+    while (n > 6) {
+        uint16_t bi = 0, bj = 1, bd = 0;
+        int16_t best = 0x7FFF;
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = i + 1; j < n; j++) {
+                uint16_t d = dc[i] | dc[j] | (val[i] ^ val[j]);
+                int16_t grow = (1 << filt_bits(d)) - (1 << filt_bits(dc[i])) -
+                               (1 << filt_bits(dc[j]));
+                if (grow < best) {
+                    best = grow;
+                    bi = i;
+                    bj = j;
+                    bd = d;
+                }
+            }
+        }
+        val[bi] &= ~bd;
+        dc[bi] = bd;
+        n--;
+        val[bj] = val[n];
+        dc[bj] = dc[n];
     }
 
-    /* (5) 성공 페이로드를 히스토리에 추가 */
-    mm_hist[mm_hist_cnt].len = payload_len;
-    memcpy(mm_hist[mm_hist_cnt].data, data, payload_len);
-    mm_hist_cnt++;
-    Serial.print("[DBG] verify: new history_count = ");
-    Serial.println(mm_hist_cnt);
+    /* (3) RXB0(필터 2개)/RXB1(필터 4개) 배정 중 수신 ID가 가장 적은 것,
+     *     같으면 RXB0 묶음이 많은 것, 그다음 재동기화 ID가 RXB0에 있는 것 */
+    uint16_t rs_id = MINIMAC_RESYNC_ID & STD_ID_MASK;
+    uint8_t all = (1 << n) - 1, best_set = 0, best_rank = 0, rs_set = 0;
+    for (uint8_t i = 0; i < n; i++)
+        if ((rs_id & ~dc[i]) == val[i])
+            rs_set |= 1 << i;
+    uint16_t best = 0xFFFF;
+    for (uint8_t set = 0; set <= all; set++) {
+        uint8_t cnt0 = filt_bits(set);
+        if (cnt0 > 2 || n - cnt0 > 4)
+            continue;
+        uint16_t m0, m1;
+        uint16_t cost = filt_group_cost(val, dc, set, n, &m0) +
+                        filt_group_cost(val, dc, all & ~set, n, &m1);
+        uint8_t rank = cnt0 * 2 + ((set & rs_set) != 0);
+        if (cost < best || (cost == best && rank > best_rank)) {
+            best = cost;
+            best_set = set;
+            best_rank = rank;
+        }
+    }
 
-    /* (6) 카운터 증가 및 디버그 출력 */
-    mm_counter++;
-    Serial.print("[DBG] verify: new counter = ");
-    print_u64(mm_counter);
-    Serial.println();
+    /* (4) 마스크/필터 채우기 (빈 버퍼는 다른 버퍼 설정 복사) */
+    uint8_t set0 = best_set, set1 = all & ~best_set;
+    filt_group_cost(val, dc, set0, n, &f->mask[0]);
+    filt_group_cost(val, dc, set1, n, &f->mask[1]);
+    if (set1)
+        filt_fill(f->filt + 2, 4, val, set1, n, f->mask[1]);
+    if (set0)
+        filt_fill(f->filt, 2, val, set0, n, f->mask[0]);
+    if (!set0) {
+        f->mask[0] = f->mask[1];
+        f->filt[0] = f->filt[1] = f->filt[2];
+    }
+    if (!set1) {
+        f->mask[1] = f->mask[0];
+        f->filt[2] = f->filt[3] = f->filt[4] = f->filt[5] = f->filt[0];
+    }
 
-    /* (7) EEPROM에 상태 저장 */
-    save_state();
+    /* (5) 실제로 수신되는 표준 ID 수 세기 */
+    uint16_t accepted = 0;
+    for (uint16_t x = 0; x <= STD_ID_MASK; x++) {
+        bool hit = false;
+        for (uint8_t k = 0; k < 6 && !hit; k++) {
+            uint16_t m = f->mask[k < 2 ? 0 : 1];
+            hit = (x & m) == (f->filt[k] & m);
+        }
+        accepted += hit;
+    }
 
-    Serial.println("[DBG] verify: SUCCESS");
-    return true;
+    MM_DEBUG("[DBG] minimac_can_filter: accepted IDs = ");
+    MM_DEBUGLN(accepted);
+    return accepted;
+}
+
+/**
+ * @brief 대기 중인 EEPROM 쓰기가 모두 끝날 때까지 대기
+ *
+ * 상태 저장은 EEPROM 쓰기 큐를 통해 백그라운드로 진행되므로, 전원 차단이나
+ * 리셋처럼 마지막 상태를 확실히 남겨야 하는 경로에서 호출한다.
+ */
+void minimac_flush(void)
+{
+    MM_DEBUG("[DBG] minimac_flush: pending = ");
+    MM_DEBUGLN(minimac_ee_pending());
+    minimac_ee_flush();
 }
\ No newline at end of file
@@ -0,0 +1,483 @@
+/**
+ * @file minimac_can.cpp
+ * @brief MCP2515 경량 드라이버 구현 (READ RX BUFFER / LOAD TX BUFFER 버스트)
+ *        및 TX 버퍼 3개 송신 큐
+ */
+
+#include "minimac_can.h"
+
+#ifdef MINIMAC_CAN_MOCK
+#include "minimac_can_mock.h"
+
+#define CAN_SPI_BEGIN() minimac_can_mock_select()
+#define CAN_SPI_END() minimac_can_mock_deselect()
+#define CAN_SPI_XFER(b) minimac_can_mock_transfer(b)
+#define CAN_MICROS() minimac_can_mock_micros()
+#define CAN_IRQ_OFF()
+#define CAN_IRQ_ON()
+#else
+#include <Arduino.h>
+#include <SPI.h>
+
+/// MCP2515 SPI 설정 (최대 10MHz, 모드 0,0)
+static const SPISettings CAN_SPI_SETTINGS(10000000, MSBFIRST, SPI_MODE0);
+
+#define CAN_SPI_BEGIN() SPI.beginTransaction(CAN_SPI_SETTINGS)
+#define CAN_SPI_END() SPI.endTransaction()
+#define CAN_SPI_XFER(b) SPI.transfer(b)
+#define CAN_MICROS() micros()
+#define CAN_IRQ_OFF() noInterrupts()
+#define CAN_IRQ_ON() interrupts()
+#endif
+
+#if MINIMAC_CAN_TXQ_LEN & (MINIMAC_CAN_TXQ_LEN - 1) || MINIMAC_CAN_TXQ_LEN > 128
+#error "MINIMAC_CAN_TXQ_LEN must be a power of two no larger than 128"
+#endif
+
+/// SPI 명령
+static const uint8_t INS_RESET = 0xC0;
+static const uint8_t INS_READ = 0x03;
+static const uint8_t INS_WRITE = 0x02;
+static const uint8_t INS_MODIFY = 0x05;
+static const uint8_t INS_STATUS = 0xA0;
+static const uint8_t INS_RX_STATUS = 0xB0;
+static const uint8_t INS_READ_RXB0 = 0x90; ///< RXB0SIDH부터 읽기
+static const uint8_t INS_READ_RXB1 = 0x94; ///< RXB1SIDH부터 읽기
+static const uint8_t INS_LOAD_TXB0 = 0x40; ///< TXB0SIDH부터 쓰기
+static const uint8_t INS_RTS_TXB0 = 0x81;
+static const uint8_t INS_RTS = 0x80; ///< 하위 3비트로 TXB0..2 선택
+
+/// 레지스터 주소
+static const uint8_t REG_RXF0 = 0x00; ///< RXF0..RXF2 (4바이트씩 연속)
+static const uint8_t REG_RXF3 = 0x10; ///< RXF3..RXF5 (4바이트씩 연속)
+static const uint8_t REG_RXM0 = 0x20; ///< RXM0, RXM1 (4바이트씩 연속)
+static const uint8_t REG_CANSTAT = 0x0E;
+static const uint8_t REG_CANCTRL = 0x0F;
+static const uint8_t REG_CNF3 = 0x28; ///< CNF3, CNF2, CNF1, CANINTE 순
+static const uint8_t REG_CANINTE = 0x2B;
+static const uint8_t REG_CANINTF = 0x2C;
+static const uint8_t REG_TXB0CTRL = 0x30;
+static const uint8_t REG_RXB0CTRL = 0x60;
+static const uint8_t REG_RXB1CTRL = 0x70;
+
+/// 레지스터 비트
+static const uint8_t MODE_MASK = 0xE0;     ///< CANCTRL.REQOP, CANSTAT.OPMOD
+static const uint8_t CTRL_ABAT = 0x10;     ///< CANCTRL.ABAT (전송 전체 취소)
+static const uint8_t INTE_RX = 0x03;       ///< CANINTE.RX0IE | RX1IE
+static const uint8_t INTE_TX = 0x1C;       ///< CANINTE.TX0IE | TX1IE | TX2IE
+static const uint8_t INTF_TX0 = 0x04;      ///< CANINTF.TX0IF (TXnIF = << n)
+static const uint8_t TXB_TXREQ = 0x08;     ///< TXBnCTRL.TXREQ
+static const uint8_t RXB0_BUKT = 0x04;     ///< RXB0CTRL.BUKT (rollover)
+static const uint8_t STATUS_TX0REQ = 0x04; ///< READ STATUS의 TXB0CTRL.TXREQ
+static const uint8_t STATUS_TX0IF = 0x08;  ///< READ STATUS의 CANINTF.TX0IF
+static const uint8_t STATUS_TXREQ = 0x54;  ///< READ STATUS의 TXB0..2 TXREQ
+static const uint8_t SIDL_IDE = 0x08;      ///< RXBnSIDL.IDE (확장 ID)
+static const uint8_t SIDL_SRR = 0x10;      ///< RXBnSIDL.SRR (표준 원격 프레임)
+static const uint8_t DLC_RTR = 0x40;       ///< RXBnDLC.RTR (확장 원격 프레임)
+
+/// 모드 전환·리셋·전송 취소 확인을 위한 최대 조회 횟수
+static const uint16_t MODE_POLLS = 1000;
+
+/**
+ * @brief 비트 타이밍 (CNF1..3) 한 줄
+ */
+typedef struct {
+  uint8_t osc_mhz;
+  uint16_t kbps;
+  uint8_t cnf1, cnf2, cnf3;
+} CanTiming;
+
+/// 지원하는 발진자/속도 조합 (샘플 포인트 약 75%)
+static const CanTiming CAN_TIMING[] = {
+    {8, 125, 0x01, 0xB1, 0x85},  {8, 250, 0x00, 0xB1, 0x85},
+    {8, 500, 0x00, 0x90, 0x82},  {8, 1000, 0x00, 0x80, 0x80},
+    {16, 125, 0x03, 0xF0, 0x86}, {16, 250, 0x41, 0xF1, 0x85},
+    {16, 500, 0x00, 0xF0, 0x86}, {16, 1000, 0x00, 0xD0, 0x82},
+};
+
+/**
+ * @brief SPI 트랜잭션 시작 후 CS를 LOW로
+ */
+void MiniMacCan::select(void) {
+  CAN_SPI_BEGIN();
+#ifndef MINIMAC_CAN_MOCK
+  digitalWrite(cs, LOW);
+#endif
+}
+
+/**
+ * @brief CS를 HIGH로 올린 뒤 SPI 트랜잭션 종료 (명령 완료)
+ */
+void MiniMacCan::deselect(void) {
+#ifndef MINIMAC_CAN_MOCK
+  digitalWrite(cs, HIGH);
+#endif
+  CAN_SPI_END();
+}
+
+/**
+ * @brief 레지스터 하나 읽기 (READ)
+ */
+uint8_t MiniMacCan::read_reg(uint8_t addr) {
+  select();
+  CAN_SPI_XFER(INS_READ);
+  CAN_SPI_XFER(addr);
+  uint8_t v = CAN_SPI_XFER(0);
+  deselect();
+  return v;
+}
+
+/**
+ * @brief 연속 레지스터 n개 쓰기 (WRITE, 주소 자동 증가)
+ */
+void MiniMacCan::write_regs(uint8_t addr, const uint8_t *val, uint8_t n) {
+  select();
+  CAN_SPI_XFER(INS_WRITE);
+  CAN_SPI_XFER(addr);
+  for (uint8_t i = 0; i < n; i++)
+    CAN_SPI_XFER(val[i]);
+  deselect();
+}
+
+/**
+ * @brief 레지스터 일부 비트 바꾸기 (BIT MODIFY)
+ */
+void MiniMacCan::modify_reg(uint8_t addr, uint8_t mask, uint8_t val) {
+  select();
+  CAN_SPI_XFER(INS_MODIFY);
+  CAN_SPI_XFER(addr);
+  CAN_SPI_XFER(mask);
+  CAN_SPI_XFER(val);
+  deselect();
+}
+
+/**
+ * @brief READ STATUS (RXnIF, TXnREQ, TXnIF를 한 바이트로)
+ */
+uint8_t MiniMacCan::status(void) {
+  select();
+  CAN_SPI_XFER(INS_STATUS);
+  uint8_t s = CAN_SPI_XFER(0);
+  deselect();
+  return s;
+}
+
+bool MiniMacCan::begin(uint16_t kbps, uint8_t osc_mhz) {
+  /* (1) 비트 타이밍 찾기 */
+  const CanTiming *t = NULL;
+  for (uint8_t i = 0; i < sizeof(CAN_TIMING) / sizeof(CAN_TIMING[0]); i++)
+    if (CAN_TIMING[i].osc_mhz == osc_mhz && CAN_TIMING[i].kbps == kbps)
+      t = &CAN_TIMING[i];
+  if (!t)
+    return false;
+
+  /* (2) SPI 시작, 소프트 리셋 후 설정 모드 진입 확인 (발진자 안정화 대기) */
+#ifndef MINIMAC_CAN_MOCK
+  pinMode(cs, OUTPUT);
+  digitalWrite(cs, HIGH);
+  SPI.begin();
+#endif
+  select();
+  CAN_SPI_XFER(INS_RESET);
+  deselect();
+  rxb1_old = false;
+  uint16_t n = 0;
+  while ((read_reg(REG_CANSTAT) & MODE_MASK) != MODE_CONFIG)
+    if (++n == MODE_POLLS)
+      return false;
+
+  /* (3) CNF3, CNF2, CNF1, CANINTE를 한 번에 (주소 연속) */
+  const uint8_t cnf[4] = {t->cnf3, t->cnf2, t->cnf1, INTE_RX};
+  write_regs(REG_CNF3, cnf, sizeof(cnf));
+
+  /* (4) 수신 버퍼: 마스크/필터 사용, RXB0 → RXB1 rollover */
+  modify_reg(REG_RXB0CTRL, 0x60 | RXB0_BUKT, RXB0_BUKT);
+  modify_reg(REG_RXB1CTRL, 0x60, 0x00);
+  return true;
+}
+
+bool MiniMacCan::set_mode(uint8_t mode) {
+  modify_reg(REG_CANCTRL, MODE_MASK, mode);
+  for (uint16_t n = 0; n < MODE_POLLS; n++)
+    if ((read_reg(REG_CANSTAT) & MODE_MASK) == mode)
+      return true;
+  return false;
+}
+
+void MiniMacCan::set_filter(const uint16_t *mask, const uint16_t *filt) {
+  /* 한 항목 = SIDH, SIDL(EXIDE = 0), EID8, EID0 */
+  uint8_t r[12];
+  for (uint8_t i = 0; i < 3; i++) {
+    r[4 * i] = (uint8_t)(filt[i] >> 3);
+    r[4 * i + 1] = (uint8_t)(filt[i] << 5);
+    r[4 * i + 2] = r[4 * i + 3] = 0;
+  }
+  write_regs(REG_RXF0, r, 12);
+  for (uint8_t i = 0; i < 3; i++) {
+    r[4 * i] = (uint8_t)(filt[3 + i] >> 3);
+    r[4 * i + 1] = (uint8_t)(filt[3 + i] << 5);
+  }
+  write_regs(REG_RXF3, r, 12);
+  for (uint8_t i = 0; i < 2; i++) {
+    r[4 * i] = (uint8_t)(mask[i] >> 3);
+    r[4 * i + 1] = (uint8_t)(mask[i] << 5);
+  }
+  write_regs(REG_RXM0, r, 8);
+}
+
+bool MiniMacCan::read(uint32_t *id, uint8_t *len, uint8_t *data) {
+  /* (1) RX STATUS: 프레임이 든 버퍼 (bit 6 = RXB0, bit 7 = RXB1) */
+  select();
+  CAN_SPI_XFER(INS_RX_STATUS);
+  uint8_t rx = CAN_SPI_XFER(0);
+  deselect();
+  if (!(rx & 0xC0))
+    return false;
+
+  /* (2) 먼저 도착한 버퍼 고르기: 둘 다 차 있으면 보통 RXB0가 먼저지만
+   *     (RXB1은 rollover로 채워짐), RXB1이 차 있는 채로 RXB0를 읽었다면
+   *     그 뒤 RXB0에 새로 들어온 프레임보다 RXB1이 먼저다 */
+  bool rxb1 = !(rx & 0x40) || ((rx & 0x80) && rxb1_old);
+  rxb1_old = !rxb1 && (rx & 0x80);
+
+  /* (3) READ RX BUFFER: SIDH, SIDL, EID8, EID0, DLC, 데이터를 한 번에
+   *     (CS를 올리면 칩이 해당 RXnIF를 지움) */
+  select();
+  CAN_SPI_XFER(rxb1 ? INS_READ_RXB1 : INS_READ_RXB0);
+  uint8_t sidh = CAN_SPI_XFER(0);
+  uint8_t sidl = CAN_SPI_XFER(0);
+  uint8_t eid8 = CAN_SPI_XFER(0);
+  uint8_t eid0 = CAN_SPI_XFER(0);
+  uint8_t dlc = CAN_SPI_XFER(0);
+  uint8_t n = dlc & 0x0F;
+  if (n > 8)
+    n = 8;
+  for (uint8_t i = 0; i < n; i++)
+    data[i] = CAN_SPI_XFER(0);
+  deselect();
+
+  /* (4) ID 복원 (확장 ID는 bit 31, 원격 프레임은 bit 30) */
+  uint32_t v = (uint32_t)sidh << 3 | sidl >> 5;
+  if (sidl & SIDL_IDE) {
+    v = v << 18 | (uint32_t)(sidl & 0x03) << 16 | (uint16_t)eid8 << 8 | eid0;
+    v |= 0x80000000UL;
+    if (dlc & DLC_RTR)
+      v |= 0x40000000UL;
+  } else if (sidl & SIDL_SRR) {
+    v |= 0x40000000UL;
+  }
+  *id = v;
+  *len = n;
+  return true;
+}
+
+bool MiniMacCan::send(uint16_t id, uint8_t len, const uint8_t *data) {
+  if (len > 8)
+    len = 8;
+
+  /* (1) LOAD TX BUFFER: SIDH, SIDL, EID8, EID0, DLC, 데이터를 한 번에 */
+  select();
+  CAN_SPI_XFER(INS_LOAD_TXB0);
+  CAN_SPI_XFER((uint8_t)(id >> 3));
+  CAN_SPI_XFER((uint8_t)(id << 5));
+  CAN_SPI_XFER(0);
+  CAN_SPI_XFER(0);
+  CAN_SPI_XFER(len);
+  for (uint8_t i = 0; i < len; i++)
+    CAN_SPI_XFER(data[i]);
+  deselect();
+
+  /* (2) RTS로 전송 요청 */
+  select();
+  CAN_SPI_XFER(INS_RTS_TXB0);
+  deselect();
+
+  /* (3) TXREQ가 풀릴 때까지 대기, 시간 초과면 요청 취소 */
+  uint32_t start = CAN_MICROS();
+  uint8_t s;
+  while ((s = status()) & STATUS_TX0REQ) {
+    if (CAN_MICROS() - start >= TX_TIMEOUT_US) {
+      /* 이미 전송 중인 프레임은 끝까지 나가므로 TXREQ가 풀릴 때까지 본다 */
+      modify_reg(REG_TXB0CTRL, TXB_TXREQ, 0);
+      for (uint16_t n = 0; n < MODE_POLLS; n++)
+        if (!((s = status()) & STATUS_TX0REQ))
+          break;
+      break;
+    }
+  }
+
+  /* (4) TX0IF가 켜졌으면 전송 완료 (플래그는 다음 전송을 위해 지움) */
+  bool sent = s & STATUS_TX0IF;
+  if (sent)
+    modify_reg(REG_CANINTF, INTF_TX0, 0);
+  return sent;
+}
+
+void MiniMacCan::set_irq(bool rx, bool tx) {
+  const uint8_t inte = (rx ? INTE_RX : 0) | (tx ? INTE_TX : 0);
+  write_regs(REG_CANINTE, &inte, 1);
+}
+
+void MiniMacCan::tx_load(uint8_t n, uint8_t prio, uint16_t id, uint8_t len,
+                         const uint8_t *data) {
+  if (len > 8)
+    len = 8;
+
+  /* (1) WRITE: TXBnCTRL(TXP), SIDH, SIDL, EID8, EID0, DLC, 데이터를 한 번에 */
+  select();
+  CAN_SPI_XFER(INS_WRITE);
+  CAN_SPI_XFER((uint8_t)(REG_TXB0CTRL + 0x10 * n));
+  CAN_SPI_XFER(prio & 0x03);
+  CAN_SPI_XFER((uint8_t)(id >> 3));
+  CAN_SPI_XFER((uint8_t)(id << 5));
+  CAN_SPI_XFER(0);
+  CAN_SPI_XFER(0);
+  CAN_SPI_XFER(len);
+  for (uint8_t i = 0; i < len; i++)
+    CAN_SPI_XFER(data[i]);
+  deselect();
+
+  /* (2) RTS로 전송 요청 */
+  select();
+  CAN_SPI_XFER((uint8_t)(INS_RTS | 1 << n));
+  deselect();
+}
+
+uint8_t MiniMacCan::tx_done(void) {
+  /* READ STATUS의 TX0IF, TX1IF, TX2IF는 bit 3, 5, 7 */
+  uint8_t s = status();
+  uint8_t done = (s >> 3 & 0x01) | (s >> 4 & 0x02) | (s >> 5 & 0x04);
+  if (done)
+    modify_reg(REG_CANINTF, (uint8_t)(done << 2), 0);
+  return done;
+}
+
+void MiniMacCan::tx_abort(void) {
+  modify_reg(REG_CANCTRL, CTRL_ABAT, CTRL_ABAT);
+  for (uint16_t n = 0; n < MODE_POLLS; n++)
+    if (!(status() & STATUS_TXREQ))
+      break;
+  modify_reg(REG_CANCTRL, CTRL_ABAT, 0);
+}
+
+void MiniMacCanTx::begin(void) {
+  head = tail = busy = prio = 0;
+  fly_head = fly_tail = 0;
+  can.tx_done();
+  can.set_irq(false, true);
+}
+
+/**
+ * @brief 빈 TX 버퍼를 큐의 앞 프레임으로 채움 (인터럽트가 막힌 상태에서)
+ *
+ * 대기 중인 버퍼가 없으면 우선순위 3부터 시작하고, 있으면 마지막으로 채운
+ * 버퍼보다 하나 낮춰 먼저 넣은 프레임이 먼저 나가게 합니다.
+ */
+void MiniMacCanTx::fill(void) {
+  while (tail != head) {
+    uint8_t p;
+    if (!busy)
+      p = 3;
+    else if (prio)
+      p = prio - 1;
+    else
+      return;
+    uint8_t n = 0;
+    while (busy & (1 << n))
+      n++;
+    if (n == 3)
+      return;
+    const Frame *f = &q[tail & (MINIMAC_CAN_TXQ_LEN - 1)];
+    can.tx_load(n, p, f->id, f->len, f->data);
+    fly[fly_head++ & 3] = f->tag;
+    busy |= 1 << n;
+    prio = p;
+    tail++;
+  }
+}
+
+/**
+ * @brief TX 버퍼에 먼저 채운 프레임부터 bufs개의 전송 결과를 알림
+ *
+ * 버퍼는 채운 순서대로 비므로(fill()의 우선순위) 끝난 버퍼 수만 알면
+ * 어떤 프레임인지 정해집니다.
+ */
+void MiniMacCanTx::report(uint8_t bufs, bool sent) {
+  for (; bufs; bufs >>= 1) {
+    if (!(bufs & 1))
+      continue;
+    void *tag = fly[fly_tail++ & 3];
+    if (done && tag)
+      done(tag, sent);
+  }
+}
+
+bool MiniMacCanTx::push(uint16_t id, uint8_t len, const uint8_t *data,
+                        void *tag) {
+  if (!room())
+    return false;
+  if (len > 8)
+    len = 8;
+
+  /* (1) 큐 끝에 복사 (head는 ISR이 읽기만 하므로 쓰고 나서 올림) */
+  Frame *f = &q[head & (MINIMAC_CAN_TXQ_LEN - 1)];
+  f->id = id;
+  f->len = len;
+  f->tag = tag;
+  for (uint8_t i = 0; i < len; i++)
+    f->data[i] = data[i];
+
+  /* (2) 빈 버퍼가 있으면 바로 옮김 (ISR의 fill()과 겹치지 않게) */
+  CAN_IRQ_OFF();
+  head++;
+  fill();
+  CAN_IRQ_ON();
+  return true;
+}
+
+bool MiniMacCanTx::room(void) const {
+  return (uint8_t)(head - tail) < MINIMAC_CAN_TXQ_LEN;
+}
+
+uint8_t MiniMacCanTx::pending(void) const {
+  CAN_IRQ_OFF();
+  uint8_t n = (uint8_t)(head - tail);
+  for (uint8_t b = busy; b; b >>= 1)
+    n += b & 1;
+  CAN_IRQ_ON();
+  return n;
+}
+
+void MiniMacCanTx::service(void) {
+  uint8_t fin;
+  do {
+    fin = can.tx_done();
+    report(busy & fin, true);
+    busy &= ~fin;
+    fill();
+  } while (fin);
+}
+
+uint8_t MiniMacCanTx::abort(void) {
+  CAN_IRQ_OFF();
+  can.tx_abort();
+  uint8_t fin = busy & can.tx_done();
+  uint8_t lost = busy & ~fin;
+
+  /* (1) 중단 전에 끝난 버퍼, 남은 버퍼 순으로 알림 (채운 순서) */
+  report(fin, true);
+  report(lost, false);
+
+  /* (2) 버퍼에 옮기지 못한 큐의 프레임은 큐 순서대로 실패 */
+  uint8_t n = (uint8_t)(head - tail);
+  for (; tail != head; tail++) {
+    void *tag = q[tail & (MINIMAC_CAN_TXQ_LEN - 1)].tag;
+    if (done && tag)
+      done(tag, false);
+  }
+  for (; lost; lost >>= 1)
+    n += lost & 1;
+  busy = 0;
+  CAN_IRQ_ON();
+  return n;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file minimac_eeprom.h
+ * @brief Mini-MAC EEPROM 지연 쓰기(write-behind) 큐
+ *
+ * AVR EEPROM은 바이트당 약 3.3ms가 걸리므로 EEPROM.put()으로 저널 레코드를
+ * 직접 쓰면 서명/검증 함수가 그동안 멈춰 다음 CAN 송수신이 늦어집니다. 이
+ * 모듈은 쓰기 요청(주소, 값)을 SRAM 링 버퍼에 넣고 즉시 반환하며, 실제
+ * 기록은 EE_READY 인터럽트가 한 바이트씩 이어서 처리합니다. 요청 순서대로
+ * 기록되므로 저널의 "순번을 마지막에 쓴다"는 커밋 순서가 그대로 유지됩니다.
+ *
+ * 큐에 쓰기가 남아 있는 동안 EEPROM을 직접 읽거나 쓰면 EEAR/EEDR 레지스터가
+ * 인터럽트와 충돌하므로, 그 전에 반드시 minimac_ee_flush()를 호출합니다.
+ * AVR이 아닌 환경에서는 큐 없이 EEPROM.update()로 바로 기록합니다.
+ */
+#ifndef MINIMAC_EEPROM_H
+#define MINIMAC_EEPROM_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+/** @def MINIMAC_EE_QUEUE_LEN
+ *  @brief 쓰기 큐 길이 (항목당 3바이트 SRAM, 기본 64)
+ *
+ * 저널 레코드 하나가 통째로 들어갈 만큼 잡아 두면 서명/검증 경로가 쓰기를
+ * 기다리지 않습니다. 큐가 가득 차면 빈 자리가 생길 때까지 대기합니다.
+ */
+#ifndef MINIMAC_EE_QUEUE_LEN
+#define MINIMAC_EE_QUEUE_LEN 64
+#endif
+
+/**
+ * @brief EEPROM 1바이트 쓰기 요청 (EEPROM.update()와 같이 값이 같으면 생략)
+ * @param addr  EEPROM 주소
+ * @param val   기록할 값
+ *
+ * 큐에 넣고 바로 반환합니다. 인터럽트가 꺼진 상태에서 큐가 가득 차 있으면
+ * 빠져나오지 못하므로 ISR 안에서는 호출하지 않습니다.
+ */
+void minimac_ee_write(int addr, uint8_t val);
+
+/**
+ * @brief 연속 구간 쓰기 요청 (EEPROM.put()의 지연 쓰기 버전)
+ * @param addr  EEPROM 시작 주소
+ * @param src   기록할 데이터
+ * @param len   데이터 길이(Byte)
+ */
+void minimac_ee_put(int addr, const void *src, uint16_t len);
+
+/**
+ * @brief 큐에 남은 쓰기가 모두 EEPROM에 기록될 때까지 대기 (배리어)
+ *
+ * 전원 차단·리셋 전, 또는 EEPROM을 직접 읽기/쓰기 전에 호출합니다.
+ */
+void minimac_ee_flush(void);
+
+/**
+ * @brief 아직 기록되지 않은 쓰기 요청 수
+ * @return 큐에 남은 바이트 수 (0이면 EEPROM이 최신 상태)
+ */
+uint8_t minimac_ee_pending(void);
+
+#endif // MINIMAC_EEPROM_H
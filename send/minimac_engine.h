@@ -0,0 +1,1340 @@
+/**
+ * @file minimac_engine.h
+ * @brief 키/태그 길이, λ, 최대 페이로드와 MAC을 템플릿 인자로 받는 Mini-MAC 엔진
+ *
+ * MiniMac<KeyLen, TagLen, Lambda, MaxData, Mac> 하나가 보호 대상 CAN ID 하나의
+ * 상태(카운터, 히스토리, MAC 키 상태, EEPROM 저널 위치)를 가집니다.
+ * 다이제스트 입력 최대 길이, 히스토리 링 버퍼와 슬롯 크기, 저널 레코드와
+ * EEPROM 사용량은 모두 constexpr로 정해지고, 카운터 변환처럼 길이가
+ * 인자로 정해지는 루프는 컴파일러가 펼칠 수 있습니다. 서로 다른 설정의
+ * 엔진을 한 펌웨어에 섞어도 실행 시 분기가 없습니다. TagLen과 Lambda는
+ * 버퍼와 EEPROM 슬롯을 잡는 상한이며, begin()에서 ID마다 그 이하의 태그
+ * 길이와 λ를 줄 수 있습니다.
+ *
+ * minimac.h의 C 함수 API와 컨텍스트 테이블은 MINIMAC_* 매크로로 만든 기본
+ * 설정 인스턴스를 쓰고, ID마다 태그 길이와 λ를 minimac_add()로 정합니다.
+ * 별도 설정의 엔진은 스케치에서 직접 선언하고,
+ * 컨텍스트 테이블 영역(MINIMAC_EE_SIZE) 밖의 EEPROM 구간을 넘겨 시작합니다.
+ * @code
+ * MiniMac<16, 2, 2, 4, MiniMacChaskey> fast;  // 고주기·짧은 태그 ID
+ * MiniMac<16, 4, 16, 8> slow;                 // 긴 히스토리 ID (HMAC-MD5)
+ *
+ * fast.begin(0x0A0, key_a, 512, 256);
+ * slow.begin(0x3C0, key_b, 768, 256);
+ * @endcode
+ */
+#ifndef MINIMAC_ENGINE_H
+#define MINIMAC_ENGINE_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "minimac.h"
+#include "minimac_eeprom.h"
+#include "minimac_mac.h"
+
+/// 지워진(빈) 저널 슬롯의 순번 값
+static const uint32_t MINIMAC_SEQ_NONE = 0xFFFFFFFF;
+
+/**
+ * @brief CRC-16/CCITT(다항식 0x1021) 누적 계산
+ * @param crc   이전 CRC 값 (시작값 0xFFFF)
+ * @param data  입력 바이트
+ * @param len   입력 길이(Byte)
+ * @return 갱신된 CRC 값
+ */
+uint16_t minimac_crc16_update(uint16_t crc, const void *data, uint16_t len);
+
+/**
+ * @brief 로그용 Serial 포트 초기화 (최초 1회, 로그가 꺼진 빌드에서는 없음)
+ */
+void minimac_log_begin(void);
+
+/**
+ * @class MiniMac
+ * @brief 보호 대상 CAN ID 하나의 Mini-MAC 엔진
+ * @tparam KeyLen    키 길이(Byte, Mac::KEY_MIN..Mac::KEY_MAX)
+ * @tparam TagLen    태그 길이 상한(Byte, 1..Mac::DIGEST_LEN, begin()의 기본값)
+ * @tparam Lambda    메시지 히스토리 길이 λ 상한 (1..254, begin()의 기본값)
+ * @tparam MaxData   페이로드 최대 길이(Byte)
+ * @tparam Mac       MAC 백엔드 (minimac_mac.h, 기본 HMAC-MD5)
+ * @tparam HistBytes 히스토리 링 버퍼 크기 (기본 λ × (1 + MaxData))
+ * @tparam Lookahead 손실 프레임 재동기화 시 시도할 최대 손실 수 (0이면 끔)
+ * @tparam TxDepth   전송 결과를 기다릴 수 있는 준비 프레임 수 (1..127)
+ */
+template <uint8_t KeyLen, uint8_t TagLen, uint8_t Lambda, uint8_t MaxData,
+          typename Mac = MiniMacHmacMd5,
+          uint16_t HistBytes = Lambda * (1 + MaxData),
+          uint8_t Lookahead = MINIMAC_LOOKAHEAD,
+          uint8_t TxDepth = MINIMAC_TX_DEPTH>
+class MiniMac {
+public:
+  //=== constexpr 레이아웃 ===
+  /// 재동기화 프레임 페이로드 길이: CAN ID 11비트 ‖ 카운터 하위 21비트
+  static constexpr uint8_t RESYNC_LEN = 4;
+  static constexpr uint8_t RESYNC_CTR_BITS = 21;
+  static constexpr uint32_t RESYNC_CTR_MASK = (1UL << RESYNC_CTR_BITS) - 1;
+
+  /// 재동기화 태그용 ID 도메인 비트 (표준 11비트 ID에는 없는 비트)
+  static constexpr uint16_t RESYNC_DOMAIN = 0x8000;
+
+  /// 다이제스트 입력 최대 길이: 카운터(8) ‖ ID(2) ‖ 히스토리 ‖ 페이로드
+  static constexpr uint16_t MAX_INPUT = 8 + 2 + Lambda * MaxData + MaxData;
+
+  /// 히스토리 슬롯: 각 페이로드는 (len + data)로 고정 슬롯에 한 번만 기록된다.
+  /// 최신 레코드가 참조하는 λ개 슬롯을 덮어쓰지 않도록 한 칸을 더 둔다.
+  static constexpr uint8_t HIST_SLOTS = Lambda + 1;
+  static constexpr int HIST_ENTRY = 1 + MaxData;
+
+  /// 저널 레코드 레이아웃: seq | counter | hist_cnt | hist_head | hist_crc | crc
+  static constexpr int REC_SEQ = 0;
+  static constexpr int REC_CTR = REC_SEQ + sizeof(uint32_t);
+  static constexpr int REC_CNT = REC_CTR + sizeof(uint64_t);
+  static constexpr int REC_HEAD = REC_CNT + sizeof(uint8_t);
+  static constexpr int REC_HCRC = REC_HEAD + sizeof(uint8_t);
+  static constexpr int REC_CRC = REC_HCRC + sizeof(uint16_t);
+  static constexpr int REC_SIZE = REC_CRC + sizeof(uint16_t);
+
+  /// EEPROM 영역 레이아웃:
+  /// 시그니처 | CAN ID | 히스토리 슬롯 | 저널 슬롯 배열 (영역 끝까지)
+  /// 시그니처에 슬롯 크기를 넣어 λ/MaxData가 바뀌면 기존 상태를 무효화한다.
+  static constexpr int SIG_ADDR = 0;
+  static constexpr uint32_t SIGVAL = (uint32_t)MINIMAC_SIG_MAGIC << 24 |
+                                     (uint32_t)HIST_SLOTS << 16 |
+                                     (uint32_t)(HIST_ENTRY & 0xFF) << 8 |
+                                     REC_SIZE;
+  static constexpr int ID_ADDR = SIG_ADDR + sizeof(uint32_t);
+  static constexpr int HIST_ADDR = ID_ADDR + sizeof(uint16_t);
+  static constexpr int DATA_ADDR = HIST_ADDR + HIST_SLOTS * HIST_ENTRY;
+
+  /// 저널 슬롯 n개를 쓸 때의 EEPROM 사용량(Byte)
+  static constexpr int ee_size(uint16_t slots) {
+    return DATA_ADDR + slots * REC_SIZE;
+  }
+
+  /// 상태를 저장하는 데 필요한 최소 EEPROM 영역 (저널 슬롯 2개)
+  static constexpr int EE_MIN = DATA_ADDR + 2 * REC_SIZE;
+
+  static_assert(KeyLen >= Mac::KEY_MIN && KeyLen <= Mac::KEY_MAX,
+                "KeyLen is not supported by the MAC backend");
+  static_assert(TagLen >= 1 && TagLen <= Mac::DIGEST_LEN,
+                "TagLen must be in 1..Mac::DIGEST_LEN");
+  static_assert(Lambda >= 1 && Lambda < 255, "Lambda must be in 1..254");
+  static_assert(MaxData >= 1, "MaxData must be >= 1");
+  static_assert(HistBytes >= 1 + MaxData && HistBytes <= 0xFFFF - MaxData,
+                "HistBytes must hold one entry and fit uint16_t");
+  static_assert(MINIMAC_CTR_RESERVE >= 1, "MINIMAC_CTR_RESERVE must be >= 1");
+  static_assert(TxDepth >= 1 && TxDepth <= 127, "TxDepth must be in 1..127");
+
+  /**
+   * @brief 키 설정 및 EEPROM 영역에서 상태 동기화
+   * @param can_id  보호할 CAN 메시지 식별자 (16비트)
+   * @param key     그룹 키 (KeyLen 바이트)
+   * @param ee_base 이 엔진이 쓸 EEPROM 영역 시작 주소
+   * @param ee_len  EEPROM 영역 크기(Byte), EE_MIN보다 작으면 저장하지 않음
+   * @param lambda  이 ID의 메시지 히스토리 길이 λ (1..Lambda)
+   * @param tag_len 이 ID의 태그 길이(Byte, 1..TagLen)
+   *
+   * 키는 그대로 보관하지 않고 MAC 백엔드(mac)의 선계산 상태로 바꿔
+   * 둔다(HMAC-MD5는 ipad/opad 블록을 흡수한 MD5 중간 상태). 영역의 저널에서 카운터와 메시지
+   * 히스토리를 불러오되(load_state), 유효한 상태가 없으면 fresh 상태로
+   * 초기화해 첫 레코드와 시그니처/ID를 기록한다. 이미 시작한 엔진에 다시
+   * 호출하면 EEPROM 상태로 재초기화한다. λ와 태그 길이가 범위를 벗어나면
+   * 템플릿 인자 값을 쓴다. 저장된 히스토리가 λ보다 길면 오래된 항목부터
+   * 버리고 이어 간다.
+   */
+  void begin(uint16_t can_id, const uint8_t *key, int ee_base, int ee_len,
+             uint8_t lambda = Lambda, uint8_t tag_len = TagLen) {
+    minimac_log_begin();
+    MM_DEBUG("[DBG] minimac begin(0x");
+    MM_DEBUG(can_id, HEX);
+    MM_DEBUGLN(")");
+
+    /* (1) CAN ID 설정 및 MAC 키 설정 (HMAC-MD5는 MD5 압축 2회 선계산) */
+    id = can_id;
+    mac.key(key, KeyLen);
+    tx_clear();
+    pend_clear();
+
+    /* (1b) 이 ID의 λ와 태그 길이 (상한은 템플릿 인자) */
+    if (lambda < 1 || lambda > Lambda || tag_len < 1 || tag_len > TagLen) {
+      MM_ERRORLN("[ERROR] minimac begin: lambda/tag length out of range");
+      lambda = Lambda;
+      tag_len = TagLen;
+    }
+    hist_max = lambda;
+    this->tag_len = tag_len;
+
+    /* (2) EEPROM 영역과 저널 크기 결정 (이전 레코드를 남기려면 슬롯 2개 이상) */
+    this->ee_base = ee_base;
+    jrnl_slots = ee_len >= EE_MIN ? (uint16_t)((ee_len - DATA_ADDR) / REC_SIZE)
+                                  : 0;
+    if (!jrnl_slots)
+      MM_ERRORLN("[ERROR] minimac begin: EEPROM region too small");
+
+    /* (3) 이전 상태 불러오기 */
+    signer = false;
+    if (!load_state()) {
+      /* 영역에 이 ID의 유효한 상태 없음: fresh 초기화 */
+      MM_DEBUGLN("[DBG] minimac begin: no EEPROM state, initialize fresh");
+
+      /* (3a) 다른 ID나 이전 레이아웃이 남긴 저널 레코드 무효화 (앞 슬롯의
+       *      무효화 쓰기가 큐에 있으면 직접 읽기와 겹치므로 읽기 전에 비움) */
+      for (uint16_t i = 0; i < jrnl_slots; i++) {
+        minimac_ee_flush();
+        if (jrnl_seq_at(i) != MINIMAC_SEQ_NONE)
+          minimac_ee_put(ee_base + DATA_ADDR + (int)i * REC_SIZE + REC_SEQ,
+                         &MINIMAC_SEQ_NONE, sizeof(MINIMAC_SEQ_NONE));
+      }
+
+      /* (3b) 카운터, 예약 상한, 히스토리 초기화 후 저널 첫 레코드로 저장 */
+      jrnl_seq = MINIMAC_SEQ_NONE;
+      reset();
+
+      /* (3c) CAN ID, 시그니처 순으로 기록 (시그니처가 커밋 지점) */
+      if (jrnl_slots) {
+        uint32_t sig = SIGVAL;
+        minimac_ee_put(ee_base + ID_ADDR, &id, sizeof(id));
+        minimac_ee_put(ee_base + SIG_ADDR, &sig, sizeof(sig));
+      }
+    }
+  }
+
+  /**
+   * @brief 카운터와 히스토리를 fresh 상태로 되돌리고 저널에 기록
+   *
+   * counter, ctr_bound, hist_cnt를 0으로 만든 뒤 save_state()로 다음
+   * 순번의 레코드를 추가한다. 이 레코드가 최신이 되므로 이전 레코드는 지우지
+   * 않아도 더 이상 읽히지 않는다. 빈 히스토리 레코드는 순번·카운터·CRC 등
+   * 18바이트뿐이며, 이미 같은 값인 바이트는 쓰기 큐에서 생략된다.
+   */
+  void reset(void) {
+    counter = 0;
+    ctr_bound = 0;
+    tx_clear();
+    pend_clear();
+    hist_clear();
+    hist_head = 0;
+    memset(hist_dirty, 0, sizeof(hist_dirty));
+    save_state();
+  }
+
+  /**
+   * @brief 송신할 메시지에 Mini-MAC 태그 생성 및 내부 상태 갱신
+   * @param data        서명할 페이로드 버퍼, 호출 후 buf[payload_len..]
+   *                    위치에 태그가 덧붙여짐
+   * @param payload_len 페이로드 길이(Byte, ≤ MaxData)
+   * @param persist     false면 EEPROM 저장을 미루고 persist()로 한 번에 저장
+   * @return 전체 전송 길이 (payload_len + tag_length()), 전송 결과를 기다리는
+   *         준비 프레임이 있으면 0
+   *
+   * 태그를 붙이고 바로 상태를 넘긴다. 프레임이 이 호출 뒤에야 버스에
+   * 나가는 동기 송신용이며, 전송 완료를 나중에 알게 되면 sign_prepare()와
+   * sign_done()을 쓴다. 준비 프레임 뒤에 끼어들면 순서가 어긋나므로
+   * 그동안은 서명하지 않는다.
+   */
+  uint8_t sign(uint8_t *data, uint8_t payload_len, bool persist = true) {
+    /* 디버그: 함수 진입 */
+    MM_DEBUGLN("[DBG] minimac_sign()");
+
+    settle();
+    if (tx_cnt) {
+      MM_ERRORLN("[ERROR] sign: frames in flight, use sign_prepare()");
+      return 0;
+    }
+    uint8_t total = attach_tag(data, payload_len);
+    signer = true;
+    apply_sign(data, payload_len, persist);
+    return total;
+  }
+
+  /**
+   * @brief 2단계 서명 1단계: 태그를 붙이고 전송 결과를 기다리는 프레임으로 등록
+   * @param data        서명할 페이로드 버퍼, 호출 후 buf[payload_len..]
+   *                    위치에 태그가 덧붙여짐
+   * @param payload_len 페이로드 길이(Byte, ≤ MaxData)
+   * @return 전체 전송 길이 (payload_len + tag_length()), 준비 프레임이 이미
+   *         TxDepth개면 0
+   *
+   * 앞서 준비한 프레임이 모두 순서대로 나간다고 보고, 그 프레임들을 더한
+   * 카운터와 히스토리로 태그를 계산한다. 카운터와 히스토리는 그대로 두고
+   * 페이로드 사본을 준비 목록 끝에 넣어, 송신 큐가 여러 프레임을 안고
+   * 있어도 프레임마다 준비 상태가 남는다. 전송 결과는 준비 순서대로
+   * sign_done() 또는 sign_commit()으로 알리고, 송신 큐에 넣지 못했으면 바로
+   * sign_abort()로 버린다.
+   *
+   * 준비한 프레임은 결과를 알기 전에 버스에 나갈 수 있으므로, 그 카운터까지
+   * EEPROM에 예약해 재부팅 후 같은 카운터를 다시 쓰지 않게 한다(tx_reserve()).
+   */
+  uint8_t sign_prepare(uint8_t *data, uint8_t payload_len) {
+    settle();
+    if (tx_cnt == TxDepth) {
+      MM_ERRORLN("[ERROR] sign_prepare: too many frames in flight");
+      return 0;
+    }
+    uint8_t total = attach_tag(data, payload_len);
+    tx_push(payload_len, data);
+    tx_reserve();
+    return total;
+  }
+
+  /**
+   * @brief 2단계 서명 2단계: 가장 먼저 준비한 프레임이 전송됐음을 반영
+   * @param data        sign_prepare()에 넘긴 페이로드 (같은 내용)
+   * @param payload_len 페이로드 길이(Byte)
+   * @param persist     false면 EEPROM 저장을 미루고 persist()로 한 번에 저장
+   * @return true  상태 갱신
+   * @return false 가장 오래된 준비 프레임이 이 페이로드의 데이터 프레임이 아님
+   *
+   * 전송 결과를 호출자가 바로 아는 경우에 쓴다. 메시지 히스토리(hist_buf)와
+   * 메시지 카운터(counter)를 갱신하고, 카운터 예약 구간을 벗어났으면
+   * EEPROM에 저장(commit_state)한다.
+   */
+  bool sign_commit(const uint8_t *data, uint8_t payload_len,
+                   bool persist = true) {
+    settle();
+    uint8_t i = tx_first;
+    if (!tx_cnt || tx_len[i] != payload_len ||
+        memcmp(tx_data[i], data, payload_len) != 0) {
+      MM_ERRORLN("[ERROR] sign_commit: not the oldest prepared frame");
+      return false;
+    }
+    tx_apply(persist);
+    return true;
+  }
+
+  /**
+   * @brief 2단계 서명 취소: 마지막으로 준비한 프레임을 버림 (송신 큐에 넣지
+   *        못했을 때)
+   *
+   * 준비는 상태를 바꾸지 않으므로 준비 목록에서 지우기만 하면 되고, 그
+   * 뒤에 준비한 프레임이 없으므로 다른 준비 프레임의 태그도 그대로 맞는다.
+   * 이미 큐에 넣은 프레임은 sign_done(false)로 되돌린다. 버스에 나갔는지
+   * 모르는 프레임을 버릴 때는 재동기화 프레임을 보낸다.
+   */
+  void sign_abort(void) {
+    MM_DEBUGLN("[DBG] sign: aborted");
+    settle();
+    if (tx_cnt)
+      tx_cnt--;
+  }
+
+  /**
+   * @brief 가장 먼저 준비한 프레임의 전송 결과 보고 (ISR에서 호출 가능)
+   * @param sent true 버스에 나감, false 버려짐
+   *
+   * 송신 큐가 준비 순서대로 부른다. 보고 횟수만 세고, 카운터·히스토리
+   * 갱신과 EEPROM 저장은 다음 서명 호출이나 pending()이 메인 루프에서
+   * 한다(settle()). 버려진 프레임 뒤의 준비 프레임은 그 페이로드를
+   * 히스토리에 넣어 서명했으므로 함께 버려야 한다.
+   */
+  void sign_done(bool sent) {
+    if (sent)
+      tx_sent++;
+    else
+      tx_lost++;
+  }
+
+  /**
+   * @brief 보고된 전송 결과를 반영한 뒤 아직 결과를 모르는 준비 프레임 수
+   */
+  uint8_t pending(void) {
+    settle();
+    return tx_cnt;
+  }
+
+  /**
+   * @brief 재동기화 프레임 준비 (송신 측, 상태 변경 없음)
+   * @param buf 프레임 버퍼 (RESYNC_LEN + tag_length()바이트 이상)
+   * @return 전송 길이 (RESYNC_LEN + tag_length()), 준비 프레임이 이미
+   *         TxDepth개면 0
+   *
+   * 페이로드는 CAN ID 11비트와 카운터 하위 RESYNC_CTR_BITS비트를 묶은
+   * 빅엔디안 32비트 값이고, 태그는 카운터 ‖ (ID | RESYNC_DOMAIN) ‖
+   * 페이로드의 MAC이다. 히스토리를 넣지 않고 ID 최상위 비트로 도메인을
+   * 나누므로 일반 프레임 태그와 섞이지 않는다. 카운터는 앞서 준비한
+   * 프레임을 더한 값이며, sign_prepare()처럼 준비 목록에 들어가 전송
+   * 결과를 sign_done() 또는 resync_commit()으로 알린다.
+   */
+  uint8_t resync_prepare(uint8_t *buf) {
+    MM_DEBUGLN("[DBG] resync_prepare()");
+
+    settle();
+    if (tx_cnt == TxDepth) {
+      MM_ERRORLN("[ERROR] resync_prepare: too many frames in flight");
+      return 0;
+    }
+    uint64_t ctr = counter + tx_cnt;
+
+    /* (1) (ID << 21) | 카운터 하위 21비트를 빅엔디안으로 기록 */
+    uint32_t w = (uint32_t)(id & 0x7FF) << RESYNC_CTR_BITS |
+                 ((uint32_t)ctr & RESYNC_CTR_MASK);
+    for (int8_t i = RESYNC_LEN - 1; i >= 0; i--) {
+      buf[i] = w & 0xFF;
+      w >>= 8;
+    }
+
+    /* (2) 재동기화 도메인 태그 계산 후 붙이기 */
+    uint8_t digest[Mac::DIGEST_LEN];
+    resync_digest(ctr, buf, digest);
+    memcpy(buf + RESYNC_LEN, digest, tag_len);
+
+    /* (3) 준비 목록에 넣고 카운터 예약 */
+    tx_push(TX_RESYNC, buf);
+    tx_reserve();
+    return RESYNC_LEN + tag_len;
+  }
+
+  /**
+   * @brief 가장 먼저 준비한 재동기화 프레임이 전송됐음을 반영 (송신 측)
+   * @return true  카운터 증가, 히스토리 비움, EEPROM 저장
+   * @return false 가장 오래된 준비 프레임이 재동기화 프레임이 아님
+   */
+  bool resync_commit(void) {
+    settle();
+    if (!tx_cnt || tx_len[tx_first] != TX_RESYNC) {
+      MM_ERRORLN("[ERROR] resync_commit: nothing prepared");
+      return false;
+    }
+    tx_apply(true);
+    return true;
+  }
+
+  /**
+   * @brief 수신한 재동기화 프레임 검증 및 상태 빨리 감기 (수신 측)
+   * @param data 수신 데이터 (페이로드 ‖ 태그)
+   * @param len  수신 길이 (RESYNC_LEN + tag_length()이어야 함)
+   * @return true  검증 성공, 카운터를 송신 측에 맞추고 히스토리를 비움
+   * @return false 길이·ID 불일치 또는 태그 불일치
+   *
+   * 송신 측 카운터는 현재 카운터 이상이면서 하위 RESYNC_CTR_BITS비트가
+   * 페이로드와 같은 가장 작은 값으로 복원한다. 따라서 카운터를 되돌리는
+   * 재전송은 2^21 뒤의 카운터로 해석되어 태그가 맞지 않고, 2^21 프레임
+   * 넘게 뒤처진 노드는 재동기화할 수 없다. 성공하면 송신 측과 같이
+   * 카운터 + 1, 빈 히스토리에서 이어 가며 상태를 바로 저장한다.
+   */
+  bool resync(const uint8_t *data, uint8_t len) {
+    MM_DEBUGLN("[DBG] resync()");
+
+    /* (1) 길이와 ID 확인 */
+    if (len != RESYNC_LEN + tag_len || resync_id(data) != (id & 0x7FF))
+      return false;
+
+    /* (2) 현재 카운터 이상에서 하위 비트가 같은 카운터 복원 */
+    uint32_t w = 0;
+    for (uint8_t i = 0; i < RESYNC_LEN; i++)
+      w = w << 8 | data[i];
+    uint64_t ctr = counter + ((w - (uint32_t)counter) & RESYNC_CTR_MASK);
+
+    /* (3) 태그 검사 후 상태 빨리 감기 */
+    uint8_t digest[Mac::DIGEST_LEN];
+    resync_digest(ctr, data, digest);
+    if (memcmp(digest, data + RESYNC_LEN, tag_len) != 0) {
+      MM_DEBUGLN("[DBG] resync: FAILED");
+      return false;
+    }
+    resync_apply(ctr);
+    MM_INFOLN("[INFO] resync: state fast-forwarded");
+    MM_DEBUG("[DBG] resync: new counter = ");
+    MM_DEBUG_U64(counter);
+    MM_DEBUGLN();
+    return true;
+  }
+
+  /**
+   * @brief 재동기화 프레임이 가리키는 CAN ID (11비트)
+   * @param data 재동기화 프레임 데이터 (RESYNC_LEN바이트 이상)
+   */
+  static uint16_t resync_id(const uint8_t *data) {
+    return (uint16_t)(data[0] << 3 | data[1] >> 5);
+  }
+
+  /**
+   * @brief 수신된 메시지의 Mini-MAC 태그 검증 및 상태 동기화
+   * @param data        검증할 페이로드 버퍼
+   * @param payload_len 페이로드 길이(Byte, ≤ MaxData)
+   * @param tag         수신된 태그 버퍼 (tag_length() 바이트)
+   * @param persist     false면 EEPROM 저장을 미루고 persist()로 한 번에 저장
+   * @return true  검증 성공 및 내부 상태 갱신
+   * @return false 검증 실패 (TAG 불일치)
+   *
+   * data와 tag를 기반으로 MAC 다이제스트를 재계산하여 수신된
+   * tag와 비교한다. 검증 성공 시 메시지 히스토리(hist_buf)와
+   * 카운터(counter)를 갱신하고 필요 시 EEPROM에 저장(commit_state)한 뒤
+   * true를 반환한다. 실패 시 false 반환하며 상태는 갱신되지 않음.
+   * Lookahead > 0이면 실패한 프레임을 보류 목록에 모아 두었다가, 이후
+   * 불일치가 나면 프레임 손실을 가정한 상태로 다시 맞춰 본다(lookahead()).
+   */
+  bool verify(const uint8_t *data, uint8_t payload_len, const uint8_t *tag,
+              bool persist = true) {
+    /* 디버그: 함수 진입 */
+    MM_DEBUGLN("[DBG] minimac_verify()");
+
+    /* (1) MAC 입력 구성 및 다이제스트 재계산 */
+    uint8_t digest[Mac::DIGEST_LEN];
+    compute_digest(counter, 0, data, payload_len, digest);
+
+    /* (2) 디버그: 기대 태그(expected) 및 수신 태그(received) 출력 */
+    MM_DEBUG("[DBG] verify: expected tag = ");
+    MM_DEBUG_HEX(digest, tag_len);
+    MM_DEBUG("[DBG] verify: recv    tag = ");
+    MM_DEBUG_HEX(tag, tag_len);
+
+    /* (3) 태그 비교: 불일치 시 손실 가정 재동기화, 그래도 틀리면 실패 처리 */
+    if (memcmp(digest, tag, tag_len) != 0) {
+      if (!lookahead(data, payload_len, tag)) {
+        MM_DEBUGLN("[DBG] verify: FAILED");
+        pend_push(data, payload_len);
+        return false;
+      }
+    } else {
+      pend_clear();
+    }
+
+    /* (4) 성공 페이로드를 히스토리에 추가 (가득 찼다면 가장 오래된 항목 삭제) */
+    hist_push(data, payload_len);
+    MM_DEBUG("[DBG] verify: new history_count = ");
+    MM_DEBUGLN(hist_cnt);
+
+    /* (5) 카운터 증가 및 디버그 출력 */
+    counter++;
+    MM_DEBUG("[DBG] verify: new counter = ");
+    MM_DEBUG_U64(counter);
+    MM_DEBUGLN();
+
+    /* (6) 예약 구간을 벗어났으면 EEPROM에 상태 저장 (일괄 처리면 나중에) */
+    if (persist)
+      commit_state();
+
+    MM_DEBUGLN("[DBG] verify: SUCCESS");
+    return true;
+  }
+
+  /**
+   * @brief 미뤄 둔 상태 저장 수행 (persist = false로 처리한 뒤 1회)
+   *
+   * 카운터가 예약 구간을 벗어났을 때만 저장하므로 여러 번 불러도 한 번만
+   * 기록된다. 저장 전에 전원이 끊기면 송신 측은 이미 쓴 카운터를 다시 쓰고
+   * 수신 측은 그 사이 검증한 프레임을 다시 허용할 수 있으므로, 일괄 처리가
+   * 끝나면 바로 호출한다.
+   */
+  void persist(void) { commit_state(); }
+
+  /// 보호 대상 CAN ID
+  uint16_t can_id(void) const { return id; }
+
+  /// 이 ID의 태그 길이(Byte)
+  uint8_t tag_length(void) const { return tag_len; }
+
+  /// 이 ID의 메시지 히스토리 길이 λ
+  uint8_t lambda(void) const { return hist_max; }
+
+  /// MAC 백엔드 (MiniMacAnyMac이면 begin() 전에 select()로 알고리즘 선택)
+  Mac &backend(void) { return mac; }
+
+private:
+  uint16_t id;           ///< CAN ID (그룹 식별자)
+  Mac mac;               ///< 키를 설정한 MAC 백엔드
+  uint64_t counter;      ///< 64비트 메시지 카운터
+  uint64_t ctr_bound;    ///< EEPROM에 예약된 카운터 상한
+  bool signer;           ///< 서명한 적이 있음 (카운터 예약은 서명 측만)
+  uint8_t hist_max;      ///< 이 ID의 λ (≤ Lambda)
+  uint8_t tag_len;       ///< 이 ID의 태그 길이 (≤ TagLen)
+  uint8_t hist_cnt;      ///< 히스토리 항목 수 (≤ λ)
+  uint16_t hist_first;   ///< 가장 오래된 항목의 링 버퍼 위치
+  uint16_t hist_end;     ///< 다음 항목을 쓸 링 버퍼 위치
+  uint16_t hist_used;    ///< 링 버퍼 사용량 (Σ 1 + len)
+  uint8_t hist_head;     ///< 가장 오래된 항목의 히스토리 슬롯
+  int ee_base;           ///< 이 엔진의 EEPROM 영역 시작 주소
+  uint16_t jrnl_slots;   ///< EEPROM 저널 슬롯 수 (0이면 저장 안 함)
+  uint32_t jrnl_seq;     ///< 마지막 저널 레코드 순번
+
+  /// 최근 λ개 메시지 히스토리 링 버퍼: 항목을 (len, data[len])으로 빈틈없이
+  /// 이어 저장한다. 끝에 걸친 항목은 나누지 않고 여분 영역까지 이어 쓴다.
+  uint8_t hist_buf[HistBytes + MaxData];
+
+  /// 마지막 저장 이후 내용이 바뀐 히스토리 슬롯 (슬롯 s → 비트 s)
+  uint8_t hist_dirty[(HIST_SLOTS + 7) / 8];
+
+  /// 마지막 성공 이후 검증에 실패한 프레임 (len, data 항목, 오래된 순)
+  uint8_t pend[Lookahead ? HistBytes + 1 + MaxData : 1];
+  uint16_t pend_used; ///< pend 사용량 (Σ 1 + len)
+  uint8_t pend_cnt;   ///< pend 항목 수 (≤ λ)
+  uint8_t pend_fail;  ///< 마지막 성공 이후 실패한 프레임 수 (255에서 포화)
+  uint8_t pend_scan;  ///< 다음 lookahead()가 시도할 후보 순번
+  bool pend_cut;      ///< λ/HistBytes 한도로 버린 항목이 있음
+
+  /// 전송 결과를 기다리는 준비 프레임 (준비 순서 링 버퍼): 페이로드 길이
+  /// (재동기화 프레임은 TX_RESYNC)와 페이로드 사본
+  uint8_t tx_len[TxDepth];
+  uint8_t tx_data[TxDepth][MaxData];
+  uint8_t tx_first;          ///< 가장 오래된 준비 프레임 위치
+  uint8_t tx_cnt;            ///< 준비 프레임 수 (≤ TxDepth)
+  volatile uint8_t tx_sent;  ///< sign_done(true) 누적 횟수 (ISR이 증가)
+  volatile uint8_t tx_lost;  ///< sign_done(false) 누적 횟수
+  uint8_t tx_sent_seen;      ///< settle()이 반영한 tx_sent
+  uint8_t tx_lost_seen;      ///< settle()이 반영한 tx_lost
+
+  /// tx_len 값: 재동기화 프레임 (페이로드 길이로는 나오지 않는 값)
+  static constexpr uint8_t TX_RESYNC = 0xFF;
+
+  /**
+   * @brief 링 버퍼 위치 pos에 있는 항목의 다음 항목 위치
+   */
+  uint16_t hist_next(uint16_t pos) const {
+    pos += 1 + hist_buf[pos];
+    return pos >= HistBytes ? 0 : pos;
+  }
+
+  /**
+   * @brief 히스토리를 비우고 링 버퍼 위치를 처음으로 되돌림
+   */
+  void hist_clear(void) {
+    hist_cnt = 0;
+    hist_first = hist_end = 0;
+    hist_used = 0;
+  }
+
+  /**
+   * @brief 가장 오래된 히스토리 항목 삭제 (O(1))
+   *
+   * 항목을 옮기지 않고 시작 위치와 히스토리 슬롯만 한 칸 전진한다.
+   */
+  void hist_drop(void) {
+    hist_used -= 1 + hist_buf[hist_first];
+    hist_first = hist_next(hist_first);
+    hist_head = (uint8_t)((hist_head + 1) % HIST_SLOTS);
+    if (--hist_cnt == 0)
+      hist_clear();
+  }
+
+  /**
+   * @brief 다이제스트 입력의 머리: 카운터(빅엔디안 8바이트) ‖ CAN ID(2바이트)
+   * @param st  MAC 스트림 상태
+   * @param ctr 이번 프레임의 카운터
+   * @param hid 흡수할 ID (일반 프레임은 id, 재동기화는 id | RESYNC_DOMAIN)
+   */
+  void absorb_header(typename Mac::State *st, uint64_t ctr,
+                     uint16_t hid) const {
+    uint8_t hdr[10];
+    for (int i = 7; i >= 0; i--) {
+      hdr[i] = ctr & 0xFF;
+      ctr >>= 8;
+    }
+    hdr[8] = (uint8_t)(hid >> 8);
+    hdr[9] = (uint8_t)(hid & 0xFF);
+    mac.update(st, hdr, sizeof(hdr));
+  }
+
+  /**
+   * @brief 재동기화 프레임 다이제스트: 카운터 ‖ (ID | RESYNC_DOMAIN) ‖ 페이로드
+   */
+  void resync_digest(uint64_t ctr, const uint8_t *payload,
+                     uint8_t digest[Mac::DIGEST_LEN]) const {
+    typename Mac::State st;
+    mac.begin(&st);
+    absorb_header(&st, ctr, id | RESYNC_DOMAIN);
+    mac.update(&st, payload, RESYNC_LEN);
+    mac.end(&st, digest);
+  }
+
+  /**
+   * @brief 카운터 ctr의 재동기화 프레임을 주고받은 상태로 전환하고 저장
+   *
+   * 카운터는 ctr + 1, 히스토리와 보류 목록은 비운다. 예약 구간 안이라도
+   * 히스토리가 바뀌었으므로 save_state()로 바로 기록한다.
+   */
+  void resync_apply(uint64_t ctr) {
+    counter = ctr + 1;
+    hist_clear();
+    pend_clear();
+    if (counter > ctr_bound)
+      ctr_bound = counter + (ctr_reserve() - 1);
+    save_state();
+  }
+
+  /**
+   * @brief 준비 목록 비우기 (그때까지의 보고 횟수는 반영한 것으로 둠)
+   */
+  void tx_clear(void) {
+    tx_first = 0;
+    tx_cnt = 0;
+    tx_sent_seen = tx_sent;
+    tx_lost_seen = tx_lost;
+  }
+
+  /// 준비 순서 i번째(0 = 가장 오래된) 준비 프레임의 링 버퍼 위치
+  uint8_t tx_at(uint8_t i) const {
+    return (uint8_t)((tx_first + i) % TxDepth);
+  }
+
+  /**
+   * @brief 준비 목록 끝에 프레임 추가 (재동기화는 len = TX_RESYNC, 사본 없음)
+   */
+  void tx_push(uint8_t len, const uint8_t *data) {
+    uint8_t i = tx_at(tx_cnt);
+    tx_len[i] = len;
+    if (len != TX_RESYNC)
+      memcpy(tx_data[i], data, len);
+    tx_cnt++;
+  }
+
+  /**
+   * @brief 가장 오래된 준비 프레임을 전송된 것으로 보고 상태를 넘김
+   * @param persist false면 데이터 프레임의 EEPROM 저장을 미룸
+   */
+  void tx_apply(bool persist) {
+    uint8_t i = tx_first;
+    tx_first = tx_at(1);
+    tx_cnt--;
+    if (tx_len[i] == TX_RESYNC)
+      resync_apply(counter);
+    else
+      apply_sign(tx_data[i], tx_len[i], persist);
+  }
+
+  /**
+   * @brief sign_done()으로 보고된 전송 결과를 준비 순서대로 반영
+   *
+   * 전송된 프레임은 tx_apply()로 상태를 넘기고, 버려진 프레임은 상태를
+   * 바꾸지 않고 준비 목록에서 지운다. 송신 큐는 한 번에 버리는 프레임보다
+   * 그 앞에서 전송된 프레임을 먼저 보고하고, 새 프레임은 이 함수를 거친
+   * 뒤에야 준비되므로 완료를 먼저 반영하면 순서가 맞는다. 보고 횟수는
+   * ISR이 늘리는 1바이트 값이므로 인터럽트를 막지 않고 읽는다.
+   */
+  void settle(void) {
+    uint8_t sent = tx_sent, lost = tx_lost;
+    for (; tx_sent_seen != sent; tx_sent_seen++)
+      if (tx_cnt)
+        tx_apply(true);
+    for (; tx_lost_seen != lost; tx_lost_seen++)
+      if (tx_cnt) {
+        MM_DEBUGLN("[DBG] sign: rolled back");
+        tx_first = tx_at(1);
+        tx_cnt--;
+      }
+  }
+
+  /**
+   * @brief 준비 프레임이 쓸 수 있는 카운터까지 EEPROM에 예약 (송신 측)
+   *
+   * 준비 프레임은 결과가 반영되기 전에 버스에 나갈 수 있으므로, 저장된
+   * 예약 상한이 counter + tx_cnt 이상이 되게 해 재부팅 후 카운터가 그
+   * 프레임들의 카운터를 다시 쓰지 않게 한다. 이때 함께 저장되는 히스토리는
+   * 반영된 것까지이므로, 준비 프레임이 나가는 사이 재부팅한 송신 노드는
+   * 부팅 후 재동기화 프레임으로 수신 노드와 다시 맞춘다.
+   */
+  void tx_reserve(void) {
+    signer = true;
+    uint64_t need = counter + tx_cnt;
+    if (need <= ctr_bound)
+      return;
+    ctr_bound = need + (ctr_reserve() - 1);
+    save_state();
+  }
+
+  /**
+   * @brief 준비 프레임을 더한 상태로 태그를 계산해 페이로드 뒤에 붙임
+   * @return 전체 전송 길이 (payload_len + tag_length())
+   */
+  uint8_t attach_tag(uint8_t *data, uint8_t payload_len) const {
+    /* (1) MAC 입력 구성 및 다이제스트 계산 */
+    uint8_t digest[Mac::DIGEST_LEN];
+    compute_digest(counter + tx_cnt, tx_cnt, data, payload_len, digest);
+
+    /* (2) 디버그: 생성된 다이제스트의 태그 부분 출력 */
+    MM_DEBUG("[DBG] sign: tag = ");
+    MM_DEBUG_HEX(digest, tag_len);
+
+    /* (3) 태그(tag_len바이트) 붙이기 */
+    memcpy(data + payload_len, digest, tag_len);
+    return payload_len + tag_len;
+  }
+
+  /**
+   * @brief 전송된 페이로드로 히스토리와 카운터를 넘김 (송신 측)
+   * @param persist false면 EEPROM 저장을 미룸
+   */
+  void apply_sign(const uint8_t *data, uint8_t len, bool persist) {
+    /* (1) 새로운 페이로드를 히스토리에 추가 (가득 찼다면 가장 오래된 항목 삭제) */
+    hist_push(data, len);
+    MM_DEBUG("[DBG] sign: new history_count = ");
+    MM_DEBUGLN(hist_cnt);
+
+    /* (2) 카운터 증가 및 디버그 출력 */
+    counter++;
+    MM_DEBUG("[DBG] sign: new counter = ");
+    MM_DEBUG_U64(counter);
+    MM_DEBUGLN();
+
+    /* (3) 예약 구간을 벗어났으면 EEPROM에 상태 저장 (일괄 처리면 나중에) */
+    if (persist)
+      commit_state();
+  }
+
+  /**
+   * @brief 확정 히스토리 뒤에 앞쪽 준비 프레임 depth개를 이어 흡수
+   * @param st    MAC 스트림 상태
+   * @param depth 이어 붙일 준비 프레임 수 (검증은 0)
+   *
+   * 준비 프레임을 차례로 hist_push()한 것과 같은 히스토리를 만든다. 그
+   * 결과는 확정 히스토리 ‖ 준비 페이로드 열에서 λ개와 HistBytes 한도에 드는
+   * 가장 긴 꼬리이므로, 앞에서 넘치는 만큼 건너뛰고 나머지를 제자리에서
+   * 흡수한다. 준비 목록에 재동기화 프레임이 있으면 그 뒤부터 시작한다.
+   */
+  void absorb_history(typename Mac::State *st, uint8_t depth) const {
+    /* (1) 마지막 재동기화 뒤의 준비 프레임부터, 없으면 확정 히스토리부터 */
+    uint8_t from = 0;
+    bool base = true;
+    for (uint8_t k = 0; k < depth; k++) {
+      if (tx_len[tx_at(k)] == TX_RESYNC) {
+        from = k + 1;
+        base = false;
+      }
+    }
+
+    /* (2) 이어 붙인 열의 항목 수와 사용량 */
+    uint16_t cnt = base ? hist_cnt : 0;
+    uint32_t used = base ? hist_used : 0;
+    for (uint8_t k = from; k < depth; k++) {
+      cnt++;
+      used += 1 + tx_len[tx_at(k)];
+    }
+
+    /* (3) 한도를 넘는 앞쪽 항목은 건너뛰고 나머지를 오래된 순으로 흡수 */
+    uint16_t pos = hist_first;
+    for (uint8_t i = 0; base && i < hist_cnt; i++, pos = hist_next(pos))
+      absorb_entry(st, hist_buf + pos + 1, hist_buf[pos], &cnt, &used);
+    for (uint8_t k = from; k < depth; k++)
+      absorb_entry(st, tx_data[tx_at(k)], tx_len[tx_at(k)], &cnt, &used);
+  }
+
+  /**
+   * @brief absorb_history()의 항목 하나: 남은 열이 한도를 넘으면 건너뜀
+   * @param cnt  이 항목부터 끝까지의 항목 수 (건너뛰면 줄어듦)
+   * @param used 이 항목부터 끝까지의 사용량 (건너뛰면 줄어듦)
+   */
+  void absorb_entry(typename Mac::State *st, const uint8_t *e, uint8_t len,
+                    uint16_t *cnt, uint32_t *used) const {
+    if (*cnt > hist_max || *used > HistBytes) {
+      (*cnt)--;
+      *used -= 1 + len;
+      return;
+    }
+    MM_TRACE("[DBG] hist = ");
+    MM_TRACE_HEX(e, len);
+    mac.update(st, e, len);
+  }
+
+  /**
+   * @brief Mini-MAC 다이제스트 계산 (MAC 백엔드)
+   * @param ctr     이번 프레임의 카운터
+   * @param depth   히스토리 뒤에 이어 붙일 준비 프레임 수 (검증은 0)
+   * @param data    서명할 페이로드 데이터 버퍼
+   * @param len     페이로드 길이(Byte)
+   * @param digest  결과 다이제스트 저장 버퍼(Mac::DIGEST_LEN바이트)
+   *
+   * 메시지 카운터(ctr), CAN ID(id), 최근 메시지 히스토리(hist_buf와 준비
+   * 프레임, absorb_history()), 그리고 현재 페이로드(data)를 순서대로 MAC
+   * 스트림에 흡수하여 다이제스트를 생성한다. 각 필드는 저장된 위치에서 바로
+   * 읽으므로 연결 버퍼 복사와 malloc/free가 없다. 입력은 최대
+   * MAX_INPUT바이트이다. 각 단계별 내부 상태는 TRACE 레벨 로그로 확인
+   * 가능하다.
+   */
+  void compute_digest(uint64_t ctr, uint8_t depth, const uint8_t *data,
+                      uint8_t len, uint8_t digest[Mac::DIGEST_LEN]) const {
+    /* (1) 미리 설정된 키 상태에서 MAC 계산 시작 */
+    typename Mac::State st;
+    mac.begin(&st);
+
+    /* (2) 카운터, CAN ID 흡수 (absorb_header):
+     *   - 64비트 카운터 빅엔디안 8바이트, id 상위·하위 바이트 순서
+     *   - (TRACE) 현재 카운터 값(10진수)과 CAN ID(16진수) 출력
+     */
+    MM_TRACE("[DBG] counter = ");
+    MM_TRACE_U64(ctr);
+    MM_TRACELN();
+    MM_TRACE("[DBG] CAN ID = 0x");
+    MM_TRACELN(id, HEX);
+
+    absorb_header(&st, ctr, id);
+
+    /* (3) 메시지 히스토리 흡수:
+     *   - 확정 히스토리와 준비 프레임 depth개를 오래된 순으로 제자리에서
+     *     흡수 (absorb_history)
+     *   - (TRACE) 각 히스토리 데이터 덤프
+     */
+    absorb_history(&st, depth);
+
+    /* (4) 현재 페이로드 흡수:
+     *   - 호출자 버퍼 data[0..len-1]를 그대로 흡수
+     *   - (TRACE) 페이로드 덤프
+     */
+    MM_TRACE("[DBG] current_data = ");
+    MM_TRACE_HEX(data, len);
+
+    mac.update(&st, data, len);
+
+    /* (5) MAC 완료:
+     *   - HMAC-MD5는 내부 해시 확정 후 (K ⊕ opad) 상태에서 외부 해시 계산
+     *     (결과는 MD5.hmac_md5(연결 버퍼, key, ...)와 비트 단위로 동일)
+     *   - (TRACE) raw 다이제스트 덤프
+     */
+    mac.end(&st, digest);
+
+    MM_TRACE("[DBG] raw MAC = ");
+    MM_TRACE_HEX(digest, Mac::DIGEST_LEN);
+  }
+
+  /**
+   * @brief 순번 seq 레코드가 기록되는 저널 슬롯의 EEPROM 시작 주소
+   *
+   * 레코드는 순번 순서대로 슬롯을 돌아가며(seq % 슬롯 수) 기록된다.
+   */
+  int jrnl_addr(uint32_t seq) const {
+    return ee_base + DATA_ADDR + (int)(seq % jrnl_slots) * REC_SIZE;
+  }
+
+  /**
+   * @brief 저널 슬롯에 기록된 레코드 순번 읽기 (CRC 미검사)
+   *
+   * EEPROM을 직접 읽으므로 쓰기 큐를 비운(minimac_ee_flush) 뒤 호출한다.
+   */
+  uint32_t jrnl_seq_at(uint16_t slot) const {
+    uint32_t seq;
+    EEPROM.get(ee_base + DATA_ADDR + (int)slot * REC_SIZE + REC_SEQ, seq);
+    return seq;
+  }
+
+  /**
+   * @brief 가장 최근에 기록된 저널 슬롯 탐색
+   * @param slot  찾은 슬롯 번호 저장 위치
+   * @return true  후보 슬롯을 찾음 (CRC는 호출자가 검사)
+   * @return false 저널이 비어 있음
+   *
+   * 순번 s인 레코드는 슬롯 s % N에 있으므로 슬롯 0..j에는 seq0..seq0+j가
+   * 연속으로 들어 있고, 그 뒤 슬롯은 한 바퀴 전 레코드이거나 비어 있다.
+   * "seq(i) == seq0 + i"인 마지막 슬롯 j를 이진 탐색으로 찾으므로 EEPROM
+   * 크기가 커져도 부팅 시 읽기 횟수는 O(log N)이다. 슬롯 0 자체가 손상된
+   * 드문 경우에만 전체 슬롯을 선형 탐색한다.
+   */
+  bool jrnl_find_newest(uint16_t *slot) const {
+    uint32_t seq0 = jrnl_seq_at(0);
+
+    if (seq0 == MINIMAC_SEQ_NONE || seq0 % jrnl_slots != 0) {
+      /* 슬롯 0이 비었거나 기록 도중 끊김: 가장 큰 순번을 선형 탐색 */
+      bool found = false;
+      uint32_t best = 0;
+      for (uint16_t i = 0; i < jrnl_slots; i++) {
+        uint32_t seq = jrnl_seq_at(i);
+        if (seq == MINIMAC_SEQ_NONE || seq % jrnl_slots != i)
+          continue;
+        if (!found || seq > best) {
+          best = seq;
+          *slot = i;
+          found = true;
+        }
+      }
+      return found;
+    }
+
+    uint16_t lo = 0, hi = jrnl_slots - 1;
+    while (lo < hi) {
+      uint16_t mid = lo + (hi - lo + 1) / 2;
+      if (jrnl_seq_at(mid) == seq0 + mid)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+    *slot = lo;
+    return true;
+  }
+
+  /**
+   * @brief 히스토리 항목 i(0 = 가장 오래된 항목)가 기록되는 히스토리 슬롯
+   */
+  uint8_t hist_slot(uint8_t i) const {
+    return (uint8_t)((hist_head + i) % HIST_SLOTS);
+  }
+
+  /**
+   * @brief 히스토리 항목 전체(오래된 순)의 CRC-16
+   *
+   * 저널 레코드에 함께 저장해, 기록 도중 끊긴 히스토리 슬롯을 찾아낸다.
+   */
+  uint16_t hist_crc(void) const {
+    uint16_t crc = 0xFFFF;
+    uint16_t pos = hist_first;
+    for (uint8_t i = 0; i < hist_cnt; i++) {
+      crc = minimac_crc16_update(crc, hist_buf + pos, 1 + hist_buf[pos]);
+      pos = hist_next(pos);
+    }
+    return crc;
+  }
+
+  /**
+   * @brief 새 페이로드를 히스토리에 추가 (가득 찼다면 가장 오래된 항목 삭제)
+   * @param data  페이로드
+   * @param len   페이로드 길이(Byte)
+   *
+   * 항목 수가 λ에 이르렀거나 사용량이 HistBytes를 넘게 되면 가장 오래된
+   * 항목부터 hist_drop()으로 버린다. 버릴지 여부는 링 버퍼 안의 배치가
+   * 아니라 사용량만으로 정하므로, 재부팅 후 다시 쌓은 노드와 그렇지 않은
+   * 노드가 같은 항목을 버린다. 사용량이 한도 이하이면 쓰기 위치부터 여분
+   * 영역 또는 가장 오래된 항목 직전까지 항상 자리가 있다. 항목을 옮기지
+   * 않으므로 λ와 무관하게 상수 시간이다. 새 항목이 놓일 히스토리 슬롯을
+   * 변경됨(hist_dirty)으로 표시해 두면 다음 save_state()에서 그 슬롯만
+   * EEPROM에 기록한다.
+   */
+  void hist_push(const uint8_t *data, uint8_t len) {
+    /* (1) 항목 수 또는 링 버퍼 공간이 모자라면 가장 오래된 항목 삭제 */
+    if (hist_cnt == hist_max) {
+      MM_DEBUGLN("[DBG] history full, dropping oldest");
+      hist_drop();
+    }
+    while (hist_used + 1 + len > HistBytes) {
+      MM_DEBUGLN("[DBG] history buffer full, dropping oldest");
+      hist_drop();
+    }
+
+    /* (2) 새 항목이 놓일 히스토리 슬롯을 변경됨으로 표시 */
+    uint8_t s = hist_slot(hist_cnt);
+    hist_dirty[s >> 3] |= (uint8_t)(1 << (s & 7));
+
+    /* (3) 쓰기 위치에 (len, data) 기록 후 쓰기 위치 전진 */
+    hist_buf[hist_end] = len;
+    memcpy(hist_buf + hist_end + 1, data, len);
+    hist_end = hist_next(hist_end);
+    hist_used += 1 + len;
+    hist_cnt++;
+  }
+  /**
+   * @brief 보류 목록 비우기 (검증 성공, 재동기화, 초기화 시)
+   */
+  void pend_clear(void) {
+    pend_used = 0;
+    pend_cnt = 0;
+    pend_fail = 0;
+    pend_scan = 0;
+    pend_cut = false;
+  }
+
+  /**
+   * @brief 검증에 실패한 프레임의 페이로드를 보류 목록에 추가
+   *
+   * hist_push()와 같은 한도(λ개, HistBytes)를 넘으면 가장 오래된 항목부터
+   * 버린다. 따라서 보류 목록은 실패 프레임 열의 "한도 안에 드는 가장 긴
+   * 꼬리"이며, 송신 측 히스토리도 같은 규칙으로 쌓이므로 손실 프레임이 이
+   * 꼬리 밖에 있으면 송신 측 히스토리와 정확히 같다.
+   */
+  void pend_push(const uint8_t *data, uint8_t len) {
+    if (!Lookahead || len > MaxData)
+      return;
+    if (pend_fail < 255)
+      pend_fail++;
+
+    pend[pend_used] = len;
+    memcpy(pend + pend_used + 1, data, len);
+    pend_used += 1 + len;
+    pend_cnt++;
+    while (pend_cnt > hist_max || pend_used > HistBytes) {
+      uint8_t n = 1 + pend[0];
+      pend_used -= n;
+      memmove(pend, pend + n, pend_used);
+      pend_cnt--;
+      pend_cut = true;
+    }
+  }
+
+  /**
+   * @brief 프레임 손실을 가정한 상태로 태그 재검사, 맞으면 그 상태를 채택
+   * @param data  페이로드
+   * @param len   페이로드 길이(Byte)
+   * @param tag   수신된 태그 (tag_length() 바이트)
+   * @return true  후보 상태가 일치해 카운터와 히스토리를 그 상태로 바꿈
+   * @return false 일치하는 후보 없음 또는 시도 조건 미충족
+   *
+   * 마지막 성공 이후 실패한 프레임 m개(pend_fail)가 송신 측 프레임이고
+   * 그 사이에 모두 j개를 잃었다고 보면 이번 프레임의 카운터는
+   * counter + m + j이다. 송신 측 히스토리는 보류 목록이 한도에 닿아
+   * 있을 때만(λ개가 찼거나 더 담을 자리가 없거나 이미 버린 항목이 있음)
+   * 손실 프레임과 무관하게 보류 목록과 같으므로, 그 전에는 시도하지 않는다.
+   *
+   * j는 1, 0, 2, -1, 3, ... 순서로 한 번에 Lookahead개만 시도하고, 맞지
+   * 않으면 다음 실패 프레임에서 이어서 시도한다(순번 255 뒤에는 처음부터).
+   * 음수 쪽은 위조·중복 프레임이 m에 섞인 경우이며, 보류 목록보다 적은
+   * 송신 프레임을 가정하는 후보(m + j ≤ 보류 항목 수)는 건너뛴다. 손실이
+   * 한 번이면 λ 프레임 안팎 뒤에, 재동기화 전에 손실이 겹쳐도 몇 프레임 더
+   * 지나면 다시 맞춰진다.
+   *
+   * 후보들은 카운터만 다르므로 MAC 키 선계산 상태와 보류 목록을 그대로
+   * 쓰고, 프레임당 추가 비용은 최대 Lookahead번의 MAC 계산이다. 일치한
+   * 태그는 보류 항목 전체를 덮으므로 그 항목들도 함께 인증된 것이다.
+   * 히스토리를 한꺼번에 다시 쓰므로 다음 저장 전에 전원이 끊기면 이전
+   * 레코드의 히스토리 CRC가 틀려 히스토리만 비운 채 복원될 수 있다.
+   */
+  bool lookahead(const uint8_t *data, uint8_t len, const uint8_t *tag) {
+    /* (1) 송신 측 히스토리가 보류 목록으로 확정될 때만 시도 */
+    if (!Lookahead || pend_cnt == 0 ||
+        !(pend_cut || pend_cnt == hist_max || pend_used + 1 > HistBytes))
+      return false;
+
+    /* (2) 손실 j개를 가정한 카운터 후보마다 다이제스트 계산 */
+    for (uint8_t tried = 0; tried < Lookahead;) {
+      uint8_t n = pend_scan++;
+      int16_t j = (n & 1) ? -(int16_t)(n >> 1) : 1 + (int16_t)(n >> 1);
+      if (pend_fail + j <= pend_cnt)
+        continue;
+      tried++;
+
+      uint64_t ctr = counter + (uint16_t)(pend_fail + j);
+      typename Mac::State st;
+      uint8_t digest[Mac::DIGEST_LEN];
+      mac.begin(&st);
+      absorb_header(&st, ctr, id);
+      for (uint16_t pos = 0; pos < pend_used; pos += 1 + pend[pos])
+        mac.update(&st, pend + pos + 1, pend[pos]);
+      mac.update(&st, data, len);
+      mac.end(&st, digest);
+      if (memcmp(digest, tag, tag_len) != 0)
+        continue;
+
+      /* (3) 일치: 카운터와 히스토리를 후보 상태로 교체 */
+      MM_INFO("[INFO] verify: resynced after lost frames: ");
+      MM_INFOLN(j);
+      counter = ctr;
+      hist_clear();
+      for (uint16_t pos = 0; pos < pend_used; pos += 1 + pend[pos])
+        hist_push(pend + pos + 1, pend[pos]);
+      pend_clear();
+      return true;
+    }
+    return false;
+  }
+
+
+  /**
+   * @brief 저널 슬롯의 레코드를 읽어 카운터와 히스토리 위치 복원
+   * @param slot  읽을 슬롯 번호
+   * @param hcrc  레코드에 저장된 히스토리 CRC 저장 위치
+   * @return true  CRC와 필드 범위가 유효하여 복원 성공
+   * @return false 비어 있거나 기록 도중 끊긴 레코드
+   */
+  bool jrnl_read(uint16_t slot, uint16_t *hcrc) {
+    int addr = ee_base + DATA_ADDR + (int)slot * REC_SIZE;
+    uint32_t seq;
+    uint16_t crc = 0xFFFF, stored;
+
+    EEPROM.get(addr + REC_SEQ, seq);
+    if (seq == MINIMAC_SEQ_NONE)
+      return false;
+    crc = minimac_crc16_update(crc, &seq, sizeof(seq));
+
+    EEPROM.get(addr + REC_CTR, ctr_bound);
+    crc = minimac_crc16_update(crc, &ctr_bound, sizeof(ctr_bound));
+    EEPROM.get(addr + REC_CNT, hist_cnt);
+    crc = minimac_crc16_update(crc, &hist_cnt, sizeof(hist_cnt));
+    EEPROM.get(addr + REC_HEAD, hist_head);
+    crc = minimac_crc16_update(crc, &hist_head, sizeof(hist_head));
+    EEPROM.get(addr + REC_HCRC, *hcrc);
+    crc = minimac_crc16_update(crc, hcrc, sizeof(*hcrc));
+
+    EEPROM.get(addr + REC_CRC, stored);
+    if (stored != crc)
+      return false;
+    if (hist_cnt > Lambda || hist_head >= HIST_SLOTS)
+      return false;
+
+    jrnl_seq = seq;
+    return true;
+  }
+
+  /**
+   * @brief 히스토리 슬롯에서 메시지 히스토리 링 버퍼 복원
+   * @param hcrc  저널 레코드에 저장된 히스토리 CRC
+   * @return true  복원한 히스토리의 CRC가 일치함
+   * @return false 길이 범위 오류 또는 CRC 불일치 (기록 도중 끊긴 슬롯)
+   *
+   * 레코드에서 읽은 항목 수(hist_cnt)와 시작 슬롯(hist_head)을 기준으로
+   * 슬롯을 오래된 순으로 읽어 hist_push()로 다시 쌓는다.
+   */
+  bool hist_read(uint16_t hcrc) {
+    uint8_t cnt = hist_cnt, head = hist_head;
+    uint8_t data[MaxData];
+    uint16_t crc = 0xFFFF;
+
+    hist_clear();
+    for (uint8_t i = 0; i < cnt; i++) {
+      int h = ee_base + HIST_ADDR + ((head + i) % HIST_SLOTS) * HIST_ENTRY;
+      uint8_t len = EEPROM.read(h);
+      if (len > MaxData)
+        return false;
+      for (uint8_t k = 0; k < len; k++)
+        data[k] = EEPROM.read(h + 1 + k);
+      crc = minimac_crc16_update(crc, &len, 1);
+      crc = minimac_crc16_update(crc, data, len);
+      hist_push(data, len);
+    }
+    return crc == hcrc;
+  }
+
+  /**
+   * @brief EEPROM 저널에서 Mini-MAC 상태 불러오기
+   *
+   * 영역에 저장된 시그니처(SIGVAL)와 CAN ID를 확인한 뒤, 가장 최근
+   * 저널 레코드를 찾아 counter, hist_cnt를 복원하고 레코드가 가리키는
+   * 히스토리 슬롯에서 메시지 히스토리 배열을 읽어 온다. 등록 순서가 바뀌어
+   * 다른 ID의 영역을 읽게 되면 ID 불일치로 fresh 상태에서 시작한다.
+   * 읽기 전에 쓰기 큐를 비워(minimac_ee_flush) 최신 기록을 보도록 한다.
+   * 최신 레코드가 기록 도중 끊겨 CRC가 맞지 않으면 바로 이전 레코드로
+   * 되돌아간다. 저장된 카운터는 예약 상한(ctr_bound)이므로 재부팅 후에는
+   * 예약 구간 끝으로 건너뛰어 이미 사용했을 수 있는 카운터 값을 재사용하지
+   * 않는다. 히스토리만 손상된 경우에는 카운터를 유지한 채 히스토리를 비운다.
+   *
+   * @return true  EEPROM에 유효한 상태가 있어 복원 성공
+   * @return false 저널 없음, 시그니처/ID 불일치 또는 유효 레코드 없음으로
+   *               초기화가 필요함
+   */
+  bool load_state(void) {
+    uint32_t sig;
+    uint16_t stored_id;
+
+    if (!jrnl_slots)
+      return false;
+
+    /* (1) 대기 중인 쓰기를 마친 뒤 시그니처(레이아웃)와 CAN ID 확인 */
+    minimac_ee_flush();
+    EEPROM.get(ee_base + SIG_ADDR, sig);
+    EEPROM.get(ee_base + ID_ADDR, stored_id);
+    if (sig != SIGVAL || stored_id != id)
+      return false;
+
+    /* (2) 최신 레코드 후보 탐색 (이진 탐색) */
+    uint16_t newest;
+    if (!jrnl_find_newest(&newest))
+      return false;
+
+    /* (3) CRC가 맞는 레코드가 나올 때까지 이전 슬롯으로 후퇴 */
+    bool ok = false;
+    uint16_t hcrc;
+    for (uint16_t k = 0; k < jrnl_slots && !ok; k++)
+      ok = jrnl_read((newest + jrnl_slots - k) % jrnl_slots, &hcrc);
+    if (!ok)
+      return false;
+    counter = ctr_bound;
+
+    /* (4) 히스토리 슬롯 복원: 손상됐으면 카운터는 유지하고 히스토리만 비움 */
+    if (!hist_read(hcrc)) {
+      MM_ERRORLN("[ERROR] load_state: history corrupted, cleared");
+      hist_clear();
+    }
+    memset(hist_dirty, 0, sizeof(hist_dirty));
+
+    /* (5) 디버그 출력으로 복원된 상태 확인 */
+    MM_DEBUGLN("[DBG] load_state: loaded from EEPROM");
+    MM_DEBUG("  seq = ");
+    MM_DEBUGLN(jrnl_seq);
+    MM_DEBUG("  counter = ");
+    MM_DEBUG_U64(counter);
+    MM_DEBUGLN();
+    MM_DEBUG("  history_count = ");
+    MM_DEBUGLN(hist_cnt);
+
+    return true;
+  }
+
+  /**
+   * @brief 바뀐 히스토리 슬롯과 새 저널 레코드만 EEPROM에 기록
+   *
+   * 마지막 저장 이후 새로 추가된 히스토리 항목(hist_dirty)만 제자리의
+   * 히스토리 슬롯에 쓰고, 예약 상한(ctr_bound), hist_cnt, 히스토리 시작
+   * 슬롯 및 CRC를 다음 순번의 저널 레코드로 다음 슬롯에 기록한다. 프레임당
+   * 바뀌는 것은 히스토리 슬롯 하나와 레코드 헤더뿐이고, EEPROM에 이미 같은
+   * 값이 있는 바이트는 쓰기 큐가 건너뛰므로 실제 쓰기는 10바이트 안팎이다.
+   *
+   * 히스토리 슬롯은 λ + 1개라서 새 항목은 최신 레코드가 참조하지 않는 슬롯에
+   * 놓이고, 레코드는 본문과 CRC를 먼저 쓰고 순번을 마지막에 쓰므로 기록
+   * 도중 전원이 끊겨도 이전 레코드와 그 히스토리가 최신으로 남는다. 저널은
+   * 영역 전체 슬롯을 돌아가며 쓰므로 셀당 쓰기 횟수가 슬롯 수만큼 줄어든다.
+   * 실제 기록은 EEPROM 쓰기 큐(minimac_ee_put)에 맡기고 바로 반환하므로
+   * 서명/검증 지연은 MAC 계산 시간만 남는다. 큐는 요청 순서대로 기록하므로
+   * 커밋 순서는 그대로 지켜진다.
+   * 서명/검증 경로에서는 commit_state()를 통해 호출한다. 저널 영역이 없는
+   * 엔진(jrnl_slots == 0)은 저장하지 않는다.
+   */
+  void save_state(void) {
+    if (!jrnl_slots)
+      return;
+
+    uint32_t seq = jrnl_seq + 1;
+    int addr = jrnl_addr(seq);
+
+    /* (1) 마지막 저장 이후 바뀐 히스토리 슬롯만 기록 (실제 길이만큼만) */
+    uint16_t pos = hist_first;
+    for (uint8_t i = 0; i < hist_cnt; i++, pos = hist_next(pos)) {
+      uint8_t s = hist_slot(i);
+      if (!(hist_dirty[s >> 3] & (1 << (s & 7))))
+        continue;
+      minimac_ee_put(ee_base + HIST_ADDR + s * HIST_ENTRY, hist_buf + pos,
+                     1 + hist_buf[pos]);
+    }
+    memset(hist_dirty, 0, sizeof(hist_dirty));
+    uint16_t hcrc = hist_crc();
+
+    /* (2) 카운터(예약 상한), 히스토리 개수/시작 슬롯/CRC 기록 */
+    uint16_t crc = minimac_crc16_update(0xFFFF, &seq, sizeof(seq));
+    minimac_ee_put(addr + REC_CTR, &ctr_bound, sizeof(ctr_bound));
+    crc = minimac_crc16_update(crc, &ctr_bound, sizeof(ctr_bound));
+    minimac_ee_put(addr + REC_CNT, &hist_cnt, sizeof(hist_cnt));
+    crc = minimac_crc16_update(crc, &hist_cnt, sizeof(hist_cnt));
+    minimac_ee_put(addr + REC_HEAD, &hist_head, sizeof(hist_head));
+    crc = minimac_crc16_update(crc, &hist_head, sizeof(hist_head));
+    minimac_ee_put(addr + REC_HCRC, &hcrc, sizeof(hcrc));
+    crc = minimac_crc16_update(crc, &hcrc, sizeof(hcrc));
+
+    /* (3) CRC 기록 후 순번 기록 (커밋 지점) */
+    minimac_ee_put(addr + REC_CRC, &crc, sizeof(crc));
+    minimac_ee_put(addr + REC_SEQ, &seq, sizeof(seq));
+    jrnl_seq = seq;
+
+    /* (4) 디버그 출력으로 저장된 상태 확인 */
+    MM_TRACELN("[DBG] save_state: saved to EEPROM");
+    MM_TRACE("  seq = ");
+    MM_TRACELN(seq);
+    MM_TRACE("  counter = ");
+    MM_TRACE_U64(ctr_bound);
+    MM_TRACELN();
+    MM_TRACE("  history_count = ");
+    MM_TRACELN(hist_cnt);
+  }
+
+  /**
+   * @brief 카운터 예약 구간을 벗어났을 때만 상태를 EEPROM에 저장
+   *
+   * 다음에 사용할 카운터(counter)가 저장된 예약 상한(ctr_bound)을
+   * 넘으면 상한을 counter + ctr_reserve() - 1로 올리고 save_state()로
+   * 기록한다. 예약 구간 안에서는 EEPROM을 쓰지 않으므로 서명 측의 쓰기
+   * 횟수가 1/MINIMAC_CTR_RESERVE로 줄어든다. MINIMAC_CTR_RESERVE가 1이거나
+   * 검증만 하는 컨텍스트면 매 프레임 저장하는 기존 동작과 같다.
+   */
+  void commit_state(void) {
+    if (counter <= ctr_bound)
+      return;
+
+    ctr_bound = counter + (ctr_reserve() - 1);
+    save_state();
+  }
+
+  /**
+   * @brief 저장 1회당 예약할 카운터 개수
+   *
+   * 검증만 하는 컨텍스트는 정확한 카운터를 저장한다(1). 재부팅한 수신
+   * 측이 예약 상한으로 건너뛰어 송신 측보다 앞서면, 카운터를 앞으로만
+   * 감는 resync()로는 다시 맞출 수 없기 때문이다.
+   */
+  uint32_t ctr_reserve(void) const {
+    return signer ? MINIMAC_CTR_RESERVE : 1;
+  }
+};
+
+#endif // MINIMAC_ENGINE_H
@@ -0,0 +1,557 @@
+/**
+ * @file minimac_mac.cpp
+ * @brief Mini-MAC MAC 백엔드 구현 (HMAC-MD5, Chaskey-12, SipHash-2-4)
+ */
+
+#include "minimac_mac.h"
+
+/**
+ * @brief HMAC 키 패드 블록을 MD5로 흡수하여 중간 상태(a, b, c, d) 저장
+ * @param key     그룹 키
+ * @param key_len 키 길이(Byte, ≤ 64)
+ * @param pad     패드 바이트 (ipad = 0x36, opad = 0x5C)
+ * @param state   64바이트 블록 처리 직후의 MD5 체이닝 값 저장 버퍼
+ *
+ * 키가 고정되어 있으므로 (K ⊕ pad) 블록의 압축 결과는 매 프레임 동일하다.
+ * 키 설정 시 한 번만 계산해 두면 서명/검증 시 MD5 압축 2회를 생략할 수
+ * 있다. 키 패드 블록은 사용 후 스택에서 지운다.
+ */
+static void absorb_key_pad(const uint8_t *key, uint8_t key_len, uint8_t pad,
+                           uint32_t state[4]) {
+  uint8_t block[MINIMAC_MD5_BLOCK_LEN];
+  memset(block, pad, sizeof(block));
+  for (uint8_t i = 0; i < key_len; i++)
+    block[i] ^= key[i];
+
+  MiniMacMd5 ctx;
+  minimac_md5_init(&ctx);
+  minimac_md5_block(ctx.state, block);
+  memcpy(state, ctx.state, sizeof(ctx.state));
+
+  memset(block, 0, sizeof(block));
+}
+
+/**
+ * @brief HMAC 키 설정: ipad/opad 블록을 흡수한 MD5 중간 상태 계산
+ * @param key     그룹 키
+ * @param key_len 키 길이(Byte, 1..64)
+ */
+void MiniMacHmacMd5::key(const uint8_t *key, uint8_t key_len) {
+  absorb_key_pad(key, key_len, 0x36, istate);
+  absorb_key_pad(key, key_len, 0x5C, ostate);
+}
+
+/**
+ * @brief 내부 해시 확정 후 (K ⊕ opad) 중간 상태에서 외부 해시 계산
+ * @param st     begin()/update()로 입력을 흡수한 상태
+ * @param digest 결과 저장 버퍼 (16바이트)
+ */
+void MiniMacHmacMd5::end(State *st, uint8_t *digest) const {
+  uint8_t inner[16];
+  minimac_md5_final(st, inner);
+  minimac_md5_resume(st, ostate, MINIMAC_MD5_BLOCK_LEN);
+  minimac_md5_update(st, inner, sizeof(inner));
+  minimac_md5_final(st, digest);
+}
+
+/* ---- Chaskey-12 ---- */
+
+/// 32비트 왼쪽 회전
+static inline uint32_t rotl32(uint32_t x, uint8_t b) {
+  return (x << b) | (x >> (32 - b));
+}
+
+/// 리틀 엔디언 32비트 읽기
+static inline uint32_t load32(const uint8_t *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+/// 리틀 엔디언 32비트 쓰기
+static inline void store32(uint8_t *p, uint32_t x) {
+  p[0] = (uint8_t)x;
+  p[1] = (uint8_t)(x >> 8);
+  p[2] = (uint8_t)(x >> 16);
+  p[3] = (uint8_t)(x >> 24);
+}
+
+/**
+ * @brief Chaskey 순열 (ROUNDS 라운드)
+ */
+static void chaskey_permute(uint32_t v[4]) {
+  for (uint8_t r = 0; r < MiniMacChaskey::ROUNDS; r++) {
+    v[0] += v[1];
+    v[1] = rotl32(v[1], 5);
+    v[1] ^= v[0];
+    v[0] = rotl32(v[0], 16);
+    v[2] += v[3];
+    v[3] = rotl32(v[3], 8);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = rotl32(v[3], 13);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = rotl32(v[1], 7);
+    v[1] ^= v[2];
+    v[2] = rotl32(v[2], 16);
+  }
+}
+
+/**
+ * @brief GF(2^128)에서 x를 곱함 (부분 키 K1 = 2K, K2 = 4K 계산용)
+ */
+static void chaskey_times2(uint32_t out[4], const uint32_t in[4]) {
+  uint32_t c = (in[3] >> 31) ? 0x87 : 0;
+  out[3] = (in[3] << 1) | (in[2] >> 31);
+  out[2] = (in[2] << 1) | (in[1] >> 31);
+  out[1] = (in[1] << 1) | (in[0] >> 31);
+  out[0] = (in[0] << 1) ^ c;
+}
+
+/**
+ * @brief 16바이트 블록 하나를 체이닝 값에 XOR
+ */
+static void chaskey_xor_block(uint32_t v[4], const uint8_t *m) {
+  for (uint8_t i = 0; i < 4; i++)
+    v[i] ^= load32(m + 4 * i);
+}
+
+/**
+ * @brief Chaskey 키 설정
+ * @param key     128비트 키
+ * @param key_len 키 길이 (16, 엔진이 KEY_MIN/KEY_MAX로 컴파일 시 검사)
+ */
+void MiniMacChaskey::key(const uint8_t *key, uint8_t key_len) {
+  (void)key_len;
+  for (uint8_t i = 0; i < 4; i++)
+    k[i] = load32(key + 4 * i);
+}
+
+/**
+ * @brief 체이닝 값을 키로 시작
+ */
+void MiniMacChaskey::begin(State *st) const {
+  memcpy(st->v, k, sizeof(k));
+  st->fill = 0;
+}
+
+/**
+ * @brief 입력 흡수
+ *
+ * 마지막 블록은 K1/K2 중 어느 부분 키로 마무리할지 입력이 끝나야 알 수
+ * 있으므로, 꽉 찬 블록도 다음 입력이 들어올 때까지 buf에 남겨 둔다.
+ */
+void MiniMacChaskey::update(State *st, const void *data, uint16_t len) const {
+  const uint8_t *p = (const uint8_t *)data;
+  while (len) {
+    if (st->fill == sizeof(st->buf)) {
+      chaskey_xor_block(st->v, st->buf);
+      chaskey_permute(st->v);
+      st->fill = 0;
+    }
+    uint8_t n = sizeof(st->buf) - st->fill;
+    if (n > len)
+      n = (uint8_t)len;
+    memcpy(st->buf + st->fill, p, n);
+    st->fill += n;
+    p += n;
+    len -= n;
+  }
+}
+
+/**
+ * @brief 마지막 블록 처리 후 128비트 태그 출력
+ * @param st     begin()/update()로 입력을 흡수한 상태
+ * @param digest 결과 저장 버퍼 (16바이트)
+ *
+ * 꽉 찬 마지막 블록은 K1, 빈 입력을 포함한 짧은 블록은 0x01 0x00.. 로
+ * 채운 뒤 K2로 마무리한다.
+ */
+void MiniMacChaskey::end(State *st, uint8_t *digest) const {
+  uint32_t last[4];
+  chaskey_times2(last, k);
+  if (st->fill < sizeof(st->buf)) {
+    chaskey_times2(last, last);
+    st->buf[st->fill] = 0x01;
+    memset(st->buf + st->fill + 1, 0, sizeof(st->buf) - st->fill - 1);
+  }
+
+  chaskey_xor_block(st->v, st->buf);
+  for (uint8_t i = 0; i < 4; i++)
+    st->v[i] ^= last[i];
+  chaskey_permute(st->v);
+  for (uint8_t i = 0; i < 4; i++)
+    store32(digest + 4 * i, st->v[i] ^ last[i]);
+}
+
+/* ---- SipHash-2-4 ---- */
+
+/// 64비트 왼쪽 회전
+static inline uint64_t rotl64(uint64_t x, uint8_t b) {
+  return (x << b) | (x >> (64 - b));
+}
+
+/// 리틀 엔디언 64비트 읽기
+static inline uint64_t load64(const uint8_t *p) {
+  return (uint64_t)load32(p) | (uint64_t)load32(p + 4) << 32;
+}
+
+/**
+ * @brief SipRound n회
+ */
+static void sip_rounds(uint64_t v[4], uint8_t n) {
+  while (n--) {
+    v[0] += v[1];
+    v[1] = rotl64(v[1], 13);
+    v[1] ^= v[0];
+    v[0] = rotl64(v[0], 32);
+    v[2] += v[3];
+    v[3] = rotl64(v[3], 16);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = rotl64(v[3], 21);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = rotl64(v[1], 17);
+    v[1] ^= v[2];
+    v[2] = rotl64(v[2], 32);
+  }
+}
+
+/**
+ * @brief 64비트 블록 m 압축 (c = 2)
+ */
+static void sip_compress(uint64_t v[4], uint64_t m) {
+  v[3] ^= m;
+  sip_rounds(v, 2);
+  v[0] ^= m;
+}
+
+/**
+ * @brief SipHash 키 설정
+ * @param key     128비트 키
+ * @param key_len 키 길이 (16, 엔진이 KEY_MIN/KEY_MAX로 컴파일 시 검사)
+ */
+void MiniMacSipHash::key(const uint8_t *key, uint8_t key_len) {
+  (void)key_len;
+  k0 = load64(key);
+  k1 = load64(key + 8);
+}
+
+/**
+ * @brief 키와 초기화 상수로 v0..v3 시작
+ */
+void MiniMacSipHash::begin(State *st) const {
+  st->v[0] = k0 ^ 0x736f6d6570736575ULL;
+  st->v[1] = k1 ^ 0x646f72616e646f6dULL;
+  st->v[2] = k0 ^ 0x6c7967656e657261ULL;
+  st->v[3] = k1 ^ 0x7465646279746573ULL;
+  st->fill = 0;
+  st->total = 0;
+}
+
+/**
+ * @brief 입력 흡수 (8바이트가 찰 때마다 압축)
+ */
+void MiniMacSipHash::update(State *st, const void *data, uint16_t len) const {
+  const uint8_t *p = (const uint8_t *)data;
+  st->total += (uint8_t)len;
+  while (len) {
+    uint8_t n = sizeof(st->buf) - st->fill;
+    if (n > len)
+      n = (uint8_t)len;
+    memcpy(st->buf + st->fill, p, n);
+    st->fill += n;
+    p += n;
+    len -= n;
+    if (st->fill == sizeof(st->buf)) {
+      sip_compress(st->v, load64(st->buf));
+      st->fill = 0;
+    }
+  }
+}
+
+/**
+ * @brief 길이 바이트를 넣은 마지막 블록 처리 후 64비트 태그 출력
+ * @param st     begin()/update()로 입력을 흡수한 상태
+ * @param digest 결과 저장 버퍼 (8바이트, 리틀 엔디언)
+ */
+void MiniMacSipHash::end(State *st, uint8_t *digest) const {
+  memset(st->buf + st->fill, 0, sizeof(st->buf) - st->fill);
+  st->buf[7] = st->total;
+  sip_compress(st->v, load64(st->buf));
+
+  st->v[2] ^= 0xFF;
+  sip_rounds(st->v, 4);
+  uint64_t h = st->v[0] ^ st->v[1] ^ st->v[2] ^ st->v[3];
+  store32(digest, (uint32_t)h);
+  store32(digest + 4, (uint32_t)(h >> 32));
+}
+
+/* ---- 실행 시 선택 ---- */
+
+/**
+ * @brief 선택된 알고리즘의 키 설정
+ * @param key     그룹 키
+ * @param key_len 키 길이(Byte, Chaskey/SipHash는 16)
+ */
+void MiniMacAnyMac::key(const uint8_t *key, uint8_t key_len) {
+  switch (alg) {
+  case MINIMAC_MAC_CHASKEY:
+    k.chaskey.key(key, key_len);
+    break;
+  case MINIMAC_MAC_SIPHASH:
+    k.sip.key(key, key_len);
+    break;
+  default:
+    k.hmac.key(key, key_len);
+    break;
+  }
+}
+
+void MiniMacAnyMac::begin(State *st) const {
+  switch (alg) {
+  case MINIMAC_MAC_CHASKEY:
+    k.chaskey.begin(&st->chaskey);
+    break;
+  case MINIMAC_MAC_SIPHASH:
+    k.sip.begin(&st->sip);
+    break;
+  default:
+    k.hmac.begin(&st->md5);
+    break;
+  }
+}
+
+void MiniMacAnyMac::update(State *st, const void *data, uint16_t len) const {
+  switch (alg) {
+  case MINIMAC_MAC_CHASKEY:
+    k.chaskey.update(&st->chaskey, data, len);
+    break;
+  case MINIMAC_MAC_SIPHASH:
+    k.sip.update(&st->sip, data, len);
+    break;
+  default:
+    k.hmac.update(&st->md5, data, len);
+    break;
+  }
+}
+
+/**
+ * @brief 선택된 알고리즘으로 마무리하고 앞 8바이트(DIGEST_LEN) 출력
+ */
+void MiniMacAnyMac::end(State *st, uint8_t *digest) const {
+  uint8_t out[16];
+  switch (alg) {
+  case MINIMAC_MAC_CHASKEY:
+    k.chaskey.end(&st->chaskey, out);
+    break;
+  case MINIMAC_MAC_SIPHASH:
+    k.sip.end(&st->sip, out);
+    break;
+  default:
+    k.hmac.end(&st->md5, out);
+    break;
+  }
+  memcpy(digest, out, DIGEST_LEN);
+}
+
+#if MINIMAC_SELFTEST
+#include <MD5.h> /**< 비교 기준: ArduinoMD5 라이브러리 */
+
+/// 시험 벡터 항목 (플래시): 메시지 패턴과 기대 다이제스트
+typedef struct {
+  uint8_t key_byte; ///< HMAC 키 바이트 (0이면 MD5 시험)
+  uint8_t key_len;  ///< HMAC 키 길이(Byte)
+  uint8_t msg_byte; ///< 메시지 채움 바이트 (0이면 msg 문자열 사용)
+  uint8_t msg_len;  ///< 메시지 길이(Byte)
+  char msg[30];     ///< 메시지 문자열
+  uint8_t want[16]; ///< 기대 다이제스트
+} MiniMacKat;
+
+/// RFC 1321 부록 A.5 MD5, RFC 2202 2절 HMAC-MD5 시험 벡터
+static const MiniMacKat KATS[] PROGMEM = {
+    {0, 0, 0, 0, "",
+     {0xd4, 0x1d, 0x8c, 0xd9, 0x8f, 0x00, 0xb2, 0x04, 0xe9, 0x80, 0x09, 0x98,
+      0xec, 0xf8, 0x42, 0x7e}},
+    {0, 0, 0, 3, "abc",
+     {0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0, 0xd6, 0x96, 0x3f, 0x7d,
+      0x28, 0xe1, 0x7f, 0x72}},
+    {0, 0, 0, 26, "abcdefghijklmnopqrstuvwxyz",
+     {0xc3, 0xfc, 0xd3, 0xd7, 0x61, 0x92, 0xe4, 0x00, 0x7d, 0xfb, 0x49, 0x6c,
+      0xca, 0x67, 0xe1, 0x3b}},
+    {0x0b, 16, 0, 8, "Hi There",
+     {0x92, 0x94, 0x72, 0x7a, 0x36, 0x38, 0xbb, 0x1c, 0x13, 0xf4, 0x8e, 0xf8,
+      0x15, 0x8b, 0xfc, 0x9d}},
+    {0xaa, 16, 0xdd, 50, "",
+     {0x56, 0xbe, 0x34, 0x52, 0x1d, 0x14, 0x4c, 0x88, 0xdb, 0xb8, 0xc7, 0x33,
+      0xf0, 0xe8, 0xb3, 0xf6}},
+};
+
+/// SipHash-2-4 참조 구현 벡터: 키 00..0f, 메시지 00..0e (15바이트)
+static const uint8_t SIP_WANT[8] PROGMEM = {0xe5, 0x45, 0xbe, 0x49,
+                                            0x61, 0xca, 0x29, 0xa1};
+
+/// Chaskey 참조 구현의 시험 키 (32비트 LE 833D3433 009F389F 2398E64F 417ACF39)
+static const uint8_t CHASKEY_KEY[16] PROGMEM = {
+    0x33, 0x34, 0x3d, 0x83, 0x9f, 0x38, 0x9f, 0x00,
+    0x4f, 0xe6, 0x98, 0x23, 0x39, 0xcf, 0x7a, 0x41};
+
+/// Chaskey-12 벡터: 위 키, 메시지 00..0e (15바이트, K2)와 00..1f (32바이트, K1)
+static const uint8_t CHASKEY_LEN[2] PROGMEM = {15, 32};
+static const uint8_t CHASKEY_WANT[2][16] PROGMEM = {
+    {0x4b, 0xb4, 0xcf, 0x03, 0x63, 0x81, 0x3c, 0x28, 0x48, 0x14, 0xa7, 0xfc,
+     0xea, 0x0a, 0x0a, 0xc4},
+    {0x84, 0x27, 0x96, 0x77, 0xfa, 0x47, 0xc6, 0x07, 0x0f, 0x2c, 0x75, 0xdd,
+     0x99, 0xa7, 0xf5, 0xd2},
+};
+
+/// 블록당 사이클 측정에 쓰는 블록 수
+static const uint8_t BENCH_BLOCKS = 32;
+
+/**
+ * @brief 플래시의 기대값과 비교
+ */
+static bool kat_match(const uint8_t *got, const uint8_t *want_P, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++)
+    if (got[i] != pgm_read_byte(&want_P[i]))
+      return false;
+  return true;
+}
+
+/**
+ * @brief 백엔드 하나로 입력 전체의 다이제스트 계산
+ */
+template <typename Mac>
+static void mac_once(const Mac &mac, const uint8_t *data, uint8_t len,
+                     uint8_t *digest) {
+  typename Mac::State st;
+  mac.begin(&st);
+  mac.update(&st, data, len);
+  mac.end(&st, digest);
+}
+
+/**
+ * @brief 자체 MD5와 ArduinoMD5의 블록당 사이클 수 측정 및 출력
+ */
+static void bench_md5(void) {
+  static uint8_t blocks[BENCH_BLOCKS * MINIMAC_MD5_BLOCK_LEN];
+  for (uint16_t i = 0; i < sizeof(blocks); i++)
+    blocks[i] = (uint8_t)i;
+
+  MiniMacMd5 own;
+  minimac_md5_init(&own);
+  unsigned long t0 = micros();
+  for (uint8_t i = 0; i < BENCH_BLOCKS; i++)
+    minimac_md5_block(own.state, blocks + i * MINIMAC_MD5_BLOCK_LEN);
+  unsigned long t_own = micros() - t0;
+
+  MD5_CTX lib;
+  MD5::MD5Init(&lib);
+  t0 = micros();
+  MD5::MD5Update(&lib, blocks, sizeof(blocks));
+  unsigned long t_lib = micros() - t0;
+
+#ifdef F_CPU
+  const unsigned long per_us = F_CPU / 1000000UL;
+#else
+  const unsigned long per_us = 1;
+#endif
+  MM_INFO("[INFO] selftest: MD5 cycles/block own = ");
+  MM_INFO(t_own * per_us / BENCH_BLOCKS);
+  MM_INFO(", ArduinoMD5 = ");
+  MM_INFOLN(t_lib * per_us / BENCH_BLOCKS);
+}
+
+/**
+ * @brief MAC 구현 자체 시험
+ * @return true 모든 시험 통과
+ *
+ * (1) RFC 1321/2202 벡터로 자체 MD5와 HMAC-MD5 백엔드를 확인하고,
+ * (2) Mini-MAC 입력 크기(10..58바이트)의 메시지로 HMAC-MD5 백엔드와
+ * MD5::hmac_md5()의 출력이 같은지, (3) SipHash-2-4와 (4) Chaskey-12
+ * 벡터를 확인한 뒤 (5) 블록당 사이클 수를 출력한다.
+ */
+bool minimac_selftest(void) {
+  bool ok = true;
+  uint8_t key[16], msg[64], got[16], want[16];
+
+  /* (1) 알려진 답 시험: MD5, HMAC-MD5 */
+  for (uint8_t t = 0; t < sizeof(KATS) / sizeof(KATS[0]); t++) {
+    const MiniMacKat *k = &KATS[t];
+    uint8_t key_byte = pgm_read_byte(&k->key_byte);
+    uint8_t msg_byte = pgm_read_byte(&k->msg_byte);
+    uint8_t len = pgm_read_byte(&k->msg_len);
+    for (uint8_t i = 0; i < len; i++)
+      msg[i] = msg_byte ? msg_byte : pgm_read_byte(&k->msg[i]);
+
+    if (key_byte) {
+      MiniMacHmacMd5 mac;
+      memset(key, key_byte, sizeof(key));
+      mac.key(key, pgm_read_byte(&k->key_len));
+      mac_once(mac, msg, len, got);
+    } else {
+      MiniMacMd5 md5;
+      minimac_md5_init(&md5);
+      minimac_md5_update(&md5, msg, len);
+      minimac_md5_final(&md5, got);
+    }
+    if (!kat_match(got, k->want, 16)) {
+      MM_ERROR("[ERROR] selftest: MD5 KAT ");
+      MM_ERRORLN(t);
+      ok = false;
+    }
+  }
+
+  /* (2) ArduinoMD5 hmac_md5()와 비교 (Mini-MAC 입력 길이 범위) */
+  for (uint8_t i = 0; i < sizeof(key); i++)
+    key[i] = (uint8_t)(0x1A + 17 * i);
+  for (uint8_t i = 0; i < sizeof(msg); i++)
+    msg[i] = (uint8_t)(3 * i + 1);
+  MiniMacHmacMd5 hmac;
+  hmac.key(key, sizeof(key));
+  for (uint8_t len = 10; len <= 58; len++) {
+    mac_once(hmac, msg, len, got);
+    MD5::hmac_md5(msg, len, key, sizeof(key), want);
+    if (memcmp(got, want, sizeof(want)) != 0) {
+      MM_ERROR("[ERROR] selftest: hmac_md5 mismatch, len = ");
+      MM_ERRORLN(len);
+      ok = false;
+    }
+  }
+
+  /* (3) SipHash-2-4 참조 벡터 */
+  for (uint8_t i = 0; i < sizeof(key); i++)
+    key[i] = msg[i] = i;
+  MiniMacSipHash sip;
+  sip.key(key, sizeof(key));
+  mac_once(sip, msg, 15, got);
+  if (!kat_match(got, SIP_WANT, sizeof(SIP_WANT))) {
+    MM_ERRORLN("[ERROR] selftest: SipHash KAT");
+    ok = false;
+  }
+
+  /* (4) Chaskey-12 벡터 (짧은 마지막 블록은 K2, 꽉 찬 마지막 블록은 K1) */
+  for (uint8_t i = 0; i < sizeof(key); i++)
+    key[i] = pgm_read_byte(&CHASKEY_KEY[i]);
+  for (uint8_t i = 0; i < sizeof(msg); i++)
+    msg[i] = i;
+  MiniMacChaskey chaskey;
+  chaskey.key(key, sizeof(key));
+  for (uint8_t t = 0; t < 2; t++) {
+    mac_once(chaskey, msg, pgm_read_byte(&CHASKEY_LEN[t]), got);
+    if (!kat_match(got, CHASKEY_WANT[t], sizeof(CHASKEY_WANT[t]))) {
+      MM_ERROR("[ERROR] selftest: Chaskey KAT ");
+      MM_ERRORLN(t);
+      ok = false;
+    }
+  }
+
+  /* (5) 블록당 사이클 수 비교 */
+  bench_md5();
+
+  if (ok)
+    MM_INFOLN("[INFO] selftest: OK");
+  return ok;
+}
+#endif // MINIMAC_SELFTEST
@@ -4,13 +4,15 @@
  *
  * 이 파일은 Mini-MAC 기반의 메시지 인증을 적용하여 CAN 버스로 데이터를 송신하는
  * 예제 코드입니다. 주기적으로 페이로드 데이터를 준비하고 Mini-MAC 태그를 생성한
- * 뒤, 이를 포함한 CAN 메시지를 전송합니다.
+ * 뒤, 이를 포함한 CAN 메시지를 송신 큐(MiniMacCanTx)에 넣습니다. 큐는
+ * MCP2515의 TX 버퍼 3개를 채우고 전송 완료 인터럽트에서 다시 채우므로, 버스가
+ * 프레임을 내보내는 동안 다음 프레임에 서명할 수 있습니다. 카운터와
+ * 히스토리는 큐가 프레임마다 알리는 전송 결과로 확정하거나 되돌립니다.
  */
 
 #include "minimac.h"
-#include <EEPROM.h>
+#include "minimac_can.h"
 #include <SPI.h>
-#include <mcp_can.h>
 
 /**
  * @brief Mini-MAC 인증이 적용되는 보호 대상 CAN 메시지 식별자.
@@ -19,6 +21,19 @@
  */
 #define PROTECTED_ID 0x123
 
+/**
+ * @brief MCP2515 INT 핀이 연결된 아두이노 핀 (외부 인터럽트 가능 핀).
+ */
+#define CAN_INT_PIN 2
+
+/**
+ * @brief 송신 큐에 자리가 나기를 기다리는 최대 시간(ms).
+ *
+ * 이 시간 안에 자리가 나지 않으면 버스가 막힌 것으로 보고 대기 중인 프레임을
+ * 모두 버립니다.
+ */
+#define TX_ROOM_TIMEOUT_MS 50
+
 /**
  * @brief Mini-MAC 프로토콜에 사용되는 16바이트 비밀 키.
  *
@@ -32,74 +47,221 @@ const uint8_t SECRET_KEY[MINIMAC_KEY_LEN] = {0x1A, 0x2B, 0x3C, 0x4D, 0x5E, 0x6F,
 /**
  * @brief CAN 버스 제어 객체.
  *
- * MCP2515 CAN 트랜시버를 제어하기 위한 MCP_CAN 클래스 인스턴스이며, 칩
+ * MCP2515 CAN 트랜시버를 제어하기 위한 MiniMacCan 드라이버 인스턴스이며, 칩
  * 선택(CS)으로 10번 핀을 사용합니다.
  */
-MCP_CAN CAN(10);
+MiniMacCan CAN(10);
+
+/**
+ * @brief PROTECTED_ID의 Mini-MAC 컨텍스트 (송신 큐 프레임의 태그).
+ */
+MiniMacCtx *txCtx;
+
+/**
+ * @brief 재동기화 프레임이 버스에 나갈 때까지 true.
+ *
+ * 부팅 직후와 되돌릴 수 없는 프레임을 버린 뒤에 켜고, 재동기화 프레임의
+ * 전송 완료 알림에서 끕니다. 큐를 비우며 되돌린 재동기화 프레임은 수신
+ * 노드에 닿지 않았으므로 다시 보냅니다. 재동기화 프레임의 태그로도 씁니다.
+ */
+volatile bool resyncDue = true;
+
+/**
+ * @brief 송신 큐의 프레임별 전송 결과 알림 함수.
+ *
+ * 큐에 넣은 순서대로 불리며, PROTECTED_ID 컨텍스트에 결과를 기록합니다.
+ * 나간 프레임은 다음 서명 때 카운터와 히스토리에 반영되고, 버려진 프레임은
+ * 되돌려집니다. 인터럽트에서도 불리므로 기록만 합니다.
+ */
+void txDone(void *tag, bool sent) {
+  minimac_sign_done(txCtx, sent);
+  if (tag == &resyncDue && sent)
+    resyncDue = false;
+}
+
+/**
+ * @brief CAN 송신 큐.
+ *
+ * 프레임을 SRAM 큐에 넣고 MCP2515의 TX 버퍼 3개를 순서대로 채웁니다. 빈
+ * 버퍼는 CAN_INT_PIN 인터럽트(canIsr)에서 다시 채우고, 끝난 프레임마다
+ * txDone으로 결과를 알립니다.
+ */
+MiniMacCanTx txq(CAN, txDone);
+
+/**
+ * @brief 마지막 재동기화 프레임 송신 시각(ms).
+ */
+unsigned long lastResync;
+
+/**
+ * @brief MCP2515 INT 핀 인터럽트 처리 함수.
+ *
+ * 전송을 마친 TX 버퍼를 송신 큐의 다음 프레임으로 채웁니다.
+ */
+void canIsr() { txq.service(); }
+
+/**
+ * @brief 송신 큐와 Mini-MAC 준비 목록에 자리가 날 때까지 기다립니다.
+ *
+ * TX_ROOM_TIMEOUT_MS 안에 자리가 나지 않으면 버스가 막힌 것으로 보고
+ * txq.abort()로 대기 중인 프레임을 모두 버립니다. 큐는 그 전에 나간
+ * 프레임을 완료로, 버린 프레임을 실패로 순서대로 알리므로 카운터와
+ * 히스토리는 버스에 나간 프레임까지로 되돌아가 수신 노드와 그대로 맞습니다.
+ * 알림을 받지 못한 준비 프레임이 남아 되돌릴 수 없을 때만 그 프레임들을
+ * 버리고 resyncDue를 켜서, 재동기화 프레임으로 수신 노드가 따라오게 합니다.
+ */
+void waitTxRoom() {
+  unsigned long start = millis();
+  while (!txq.room() || minimac_sign_pending(txCtx) >= MINIMAC_TX_DEPTH) {
+    if (millis() - start >= TX_ROOM_TIMEOUT_MS) {
+      uint8_t lost = txq.abort();
+      MM_ERROR("[ERROR] TX queue stuck, dropped ");
+      MM_ERRORLN(lost);
+      while (minimac_sign_pending(txCtx)) {
+        minimac_sign_abort(txCtx);
+        resyncDue = true;
+      }
+      return;
+    }
+  }
+}
+
+/**
+ * @brief 현재 카운터를 알리는 재동기화 프레임을 송신 큐에 넣습니다.
+ *
+ * minimac_resync_prepare로 PROTECTED_ID의 카운터를 담은 인증 프레임을 만들어
+ * MINIMAC_RESYNC_ID로 큐에 넣습니다. 카운터를 넘기고 히스토리를 비우며
+ * resyncDue를 끄는 것은 프레임이 버스에 나갔다는 알림(txDone)을 받은
+ * 뒤입니다. 큐가 가득 차 넣지 못하면 minimac_sign_abort로 준비를 버립니다.
+ * 결과와 관계없이 시각을 lastResync에 기록합니다.
+ */
+void sendResync() {
+  uint8_t buf[MINIMAC_MAX_DATA + MINIMAC_TAG_MAX];
+  uint8_t len = minimac_resync_prepare(txCtx, buf);
+
+  lastResync = millis();
+  if (len && txq.push(MINIMAC_RESYNC_ID, len, buf, (void *)&resyncDue)) {
+    MM_INFOLN("[INFO] Resync queued");
+  } else {
+    if (len)
+      minimac_sign_abort(txCtx);
+    MM_ERRORLN("[ERROR] Resync queue full");
+  }
+}
+
+/**
+ * @brief minimac_can_filter로 계산한 마스크/필터를 MCP2515에 설정합니다.
+ *
+ * 필터는 표준 ID만 비교하므로 확장 ID 프레임은 수신 버퍼에 들어오지
+ * 않습니다. 설정 모드에서 호출합니다.
+ */
+void setupCanFilter() {
+  MiniMacCanFilter flt;
+  minimac_can_filter(&flt);
+  CAN.set_filter(flt.mask, flt.filt);
+}
 
 /**
  * @brief 시스템 초기화 함수로, 장치 설정을 수행합니다.
  *
  * 시리얼 통신을 115200 baud로 시작하고 Serial 포트가 열릴 때까지 대기합니다.
- * EEPROM 메모리를 전체 0xFF 값으로 초기화하여 과거 저장된 데이터를 지웁니다.
- * CAN 컨트롤러를 초기화(all ID 수신, 500kbps, 16MHz 클럭)한 후 정상 동작
- * 모드(MCP_NORMAL)로 설정합니다. Mini-MAC 프로토콜을 PROTECTED_ID와
- * SECRET_KEY로 초기화하여 메시지 인증 기능을 준비합니다 (fresh 상태 시작). 모든
- * 초기화가 완료되면 시리얼 모니터에 "[INFO] Sender Initialized" 메시지를
- * 출력합니다.
+ * CAN 컨트롤러를 설정 모드로 초기화(500kbps, 16MHz 클럭)합니다.
+ * Mini-MAC 프로토콜을 PROTECTED_ID와 SECRET_KEY로 초기화하여 메시지 인증
+ * 기능을 준비합니다. 카운터와 히스토리는 EEPROM에 저장된 상태를 이어
+ * 씁니다. 송신 노드는 프레임을 읽지 않으므로 자신이 보내는 ID만 통과하도록
+ * 하드웨어 마스크/필터를 설정해 다른 트래픽이 수신 버퍼를 차지하지 않게 한 뒤
+ * 정상 동작 모드(MODE_NORMAL)로 바꿉니다. 송신 큐를 초기화해 INT 핀이 전송
+ * 완료를 알리게 하고 CAN_INT_PIN의 하강 에지에 canIsr을 연결합니다. 수신
+ * 노드가 이 상태에 맞추도록 하는 재동기화 프레임은 resyncDue가 켜져 있으므로
+ * 첫 loop에서 보냅니다. 모든 초기화가 완료되면 시리얼 모니터에 "[INFO] Sender Initialized" 메시지를 출력합니다.
  */
 void setup() {
   Serial.begin(115200);
   while (!Serial)
     ;
 
-  // EEPROM 전체 초기화
-  for (int i = 0; i < EEPROM.length(); i++) {
-    EEPROM.write(i, 0xFF);
+  // CAN 초기화 (500kbps, 16MHz, 설정 모드에서 시작)
+  if (!CAN.begin(500, 16)) {
+    MM_ERRORLN("[ERROR] CAN Init Failed!");
+    for (;;)
+      ;
   }
 
-  // CAN 초기화 (all IDs, 500kbps, 16MHz)
-  if (CAN.begin(MCP_ANY, CAN_500KBPS, MCP_16MHZ) != CAN_OK) {
-    Serial.println("[ERROR] CAN Init Failed!");
+#if MINIMAC_SELFTEST
+  // MAC 자체 시험: 기준 벡터, ArduinoMD5와 비교, 블록당 사이클 출력
+  if (!minimac_selftest()) {
     for (;;)
       ;
   }
-  CAN.setMode(MCP_NORMAL);
+#endif
 
-  // Mini-MAC 초기화 (fresh 상태로 시작)
+  // Mini-MAC 초기화 (저장된 상태 이어 쓰기)
   minimac_init(PROTECTED_ID, SECRET_KEY);
+  txCtx = minimac_find(PROTECTED_ID);
+
+  // 하드웨어 필터: 다른 노드의 트래픽은 수신 버퍼에 넣지 않음
+  setupCanFilter();
+  CAN.set_mode(MiniMacCan::MODE_NORMAL);
+
+  // 송신 큐: 전송 완료 인터럽트로 TX 버퍼 채우기 (ISR에서 SPI 사용)
+  txq.begin();
+  pinMode(CAN_INT_PIN, INPUT);
+  SPI.usingInterrupt(digitalPinToInterrupt(CAN_INT_PIN));
+  attachInterrupt(digitalPinToInterrupt(CAN_INT_PIN), canIsr, FALLING);
 
-  Serial.println("[INFO] Sender Initialized");
+  MM_INFOLN("[INFO] Sender Initialized");
 }
 
 /**
  * @brief 주기적으로 메시지를 생성하여 전송하는 메인 루프 함수입니다.
  *
- * 예시 페이로드 데이터를 버퍼에 설정한 후, minimac_sign 함수를 호출하여 해당
- * 페이로드에 대한 Mini-MAC 인증 태그를 생성하고 부착합니다. 준비된 메시지를
- * PROTECTED_ID 식별자로 CAN 버스를 통해 송신합니다. 송신 결과를 시리얼 모니터에
- * "[INFO] Message sent" 또는 "[ERROR] Send failed" 형식으로 출력하고, 1초간
- * 대기한 후 다음 메시지를 준비합니다.
+ * 예시 페이로드 데이터를 버퍼에 설정한 후, waitTxRoom으로 송신 큐에 자리가
+ * 나기를 기다리고(부팅 후 재동기화 프레임이 아직 나가지 않았거나 막힌 큐를
+ * 비울 때 되돌릴 수 없는 프레임이 있어 resyncDue가 켜져 있으면 sendResync로
+ * 재동기화 프레임을 먼저 넣음) minimac_sign_prepare 함수를
+ * 호출하여 해당 페이로드에 대한 Mini-MAC 인증 태그를 생성하고 부착합니다.
+ * 준비된 메시지를 PROTECTED_ID 식별자로 송신 큐에 넣고 "[INFO] Message
+ * queued"를 출력합니다. 카운터와 히스토리는 큐가 그 프레임의 전송 완료를
+ * 알린 뒤에 넘어가고, 큐를 비우며 버린 프레임은 준비 순서대로 되돌려지므로
+ * 수신 노드와 어긋나지 않습니다. 전송은 인터럽트에서 진행되므로 함수는
+ * 버스를 기다리지 않고 바로 다음 프레임을 준비할 수 있습니다.
+ * MINIMAC_RESYNC_PERIOD가 0이 아니고 마지막 재동기화 프레임 이후 그 시간이
+ * 지났으면 sendResync로 재동기화 프레임을 보냅니다. 1초간 대기한 후 다음
+ * 메시지를 준비합니다.
  */
 void loop() {
   // 예시 페이로드: 0xDE 0xAD 0xBE 0xEF
-  uint8_t buf[MINIMAC_MAX_DATA + MINIMAC_TAG_LEN];
+  uint8_t buf[MINIMAC_MAX_DATA + MINIMAC_TAG_MAX];
   uint8_t payloadLen = 4;
   buf[0] = 0xDE;
   buf[1] = 0xAD;
   buf[2] = 0xBE;
   buf[3] = 0xEF;
 
-  // Mini-MAC 태그 생성
-  uint8_t totalLen = minimac_sign(buf, payloadLen);
+  // 송신 큐 자리 확보 (재동기화 프레임이 아직 나가지 않았으면 그것부터)
+  waitTxRoom();
+  if (resyncDue) {
+    sendResync();
+    waitTxRoom();
+  }
 
-  // CAN 전송
-  byte result = CAN.sendMsgBuf(PROTECTED_ID, 0, totalLen, buf);
-  if (result == CAN_OK) {
-    Serial.println("[INFO] Message sent");
+  // Mini-MAC 태그 생성 후 큐에 넣기 (상태 확정은 전송 완료 알림에서)
+  uint8_t totalLen = minimac_sign_prepare(txCtx, buf, payloadLen);
+  if (totalLen && txq.push(PROTECTED_ID, totalLen, buf, txCtx)) {
+    MM_INFOLN("[INFO] Message queued");
   } else {
-    Serial.println("[ERROR] Send failed");
+    if (totalLen)
+      minimac_sign_abort(txCtx);
+    MM_ERRORLN("[ERROR] TX queue full");
+  }
+
+#if MINIMAC_RESYNC_PERIOD
+  // 주기적 재동기화: 재부팅했거나 프레임을 놓친 수신 노드 복구
+  if (millis() - lastResync >= MINIMAC_RESYNC_PERIOD) {
+    waitTxRoom();
+    sendResync();
   }
+#endif
 
   delay(1000);
 }